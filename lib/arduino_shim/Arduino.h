@@ -0,0 +1,130 @@
+#ifndef _ARDUINO_SHIM_H
+#define _ARDUINO_SHIM_H
+
+// Host stand-in for the Arduino core, only what the project uses. Time is
+// simulated: it only moves with delay(), arduinoShimAdvance() and a small
+// step on every millis()/micros() call, so busy waits still end.
+
+#include <inttypes.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+// flash is plain memory on the host
+#define PROGMEM
+#define PSTR(s) (s)
+#define pgm_read_byte(addr) (*(const uint8_t*)(addr))
+#define pgm_read_word(addr) (*(const uint16_t*)(addr))
+#define pgm_read_dword(addr) (*(const uint32_t*)(addr))
+#define pgm_read_ptr(addr) (*(void* const*)(addr))
+#define memcpy_P memcpy
+#define strlen_P strlen
+#define strcmp_P strcmp
+#define strncmp_P strncmp
+#define strstr_P strstr
+#define sprintf_P sprintf
+#define snprintf_P snprintf
+
+class __FlashStringHelper;
+#define F(string_literal) (reinterpret_cast<const __FlashStringHelper*>(string_literal))
+
+#define HIGH 0x1
+#define LOW 0x0
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+#ifndef PI
+#define PI 3.1415926535897932384626433832795
+#endif
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+// templates rather than the AVR core macros, they would break the C++
+// standard headers the host code includes
+template<class T, class U> inline T min(T a, U b) { return a < b ? a : (T)b; }
+template<class T, class U> inline T max(T a, U b) { return a > b ? a : (T)b; }
+template<class T, class U, class V> inline T constrain(T value, U low, V high) {
+  return value < low ? (T)low : (value > high ? (T)high : value);
+}
+
+unsigned long millis(void);
+unsigned long micros(void);
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+// moves the simulated clock forward, e.g. to account for host side work
+void arduinoShimAdvance(unsigned long us);
+// time a millis()/micros() call takes, 1 us by default
+void arduinoShimSetCallCost(unsigned long us);
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+inline void interrupts(void) {}
+inline void noInterrupts(void) {}
+
+class Print {
+  public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t value) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size);
+    size_t write(const char* str) { return str == NULL ? 0 : write((const uint8_t*)str, strlen(str)); }
+    size_t write(const char* buffer, size_t size) { return write((const uint8_t*)buffer, size); }
+
+    size_t print(const __FlashStringHelper* str) { return write((const char*)str); }
+    size_t print(const char* str) { return write(str); }
+    size_t print(char value) { return write((uint8_t)value); }
+    size_t print(unsigned char value, int base = DEC) { return print((unsigned long)value, base); }
+    size_t print(int value, int base = DEC) { return print((long)value, base); }
+    size_t print(unsigned int value, int base = DEC) { return print((unsigned long)value, base); }
+    size_t print(long value, int base = DEC);
+    size_t print(unsigned long value, int base = DEC);
+    size_t print(double value, int digits = 2);
+
+    size_t println(void) { return write("\r\n"); }
+    template<class T> size_t println(T value) { size_t n = print(value); return n + println(); }
+    template<class T> size_t println(T value, int format) { size_t n = print(value, format); return n + println(); }
+};
+
+class Stream : public Print {
+  public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+};
+
+// writes to stdout, never receives anything
+class HardwareSerial : public Stream {
+  public:
+    void begin(unsigned long baud) { (void)baud; }
+    void end(void) {}
+    int available() { return 0; }
+    int read() { return -1; }
+    int peek() { return -1; }
+    void flush(void) { fflush(stdout); }
+    size_t write(uint8_t value) { return fputc(value, stdout) == EOF ? 0 : 1; }
+    using Print::write;
+    operator bool() { return true; }
+};
+
+extern HardwareSerial Serial;
+
+// only the conversions the project relies on
+class String {
+  public:
+    String(const char* str);
+    float toFloat(void) const { return atof(buffer); }
+    const char* c_str(void) const { return buffer; }
+  private:
+    char buffer[64];
+};
+
+#endif
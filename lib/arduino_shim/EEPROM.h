@@ -0,0 +1,24 @@
+#ifndef _EEPROM_SHIM_H
+#define _EEPROM_SHIM_H
+
+#include <Arduino.h>
+
+#define EEPROM_SHIM_SIZE 1024
+
+// erased ATmega328 EEPROM in RAM, writes are counted to follow the wear
+class EEPROMClass {
+  public:
+    EEPROMClass() : writes(0) { clear(); }
+    uint8_t read(int address) { return cells[address % EEPROM_SHIM_SIZE]; }
+    void write(int address, uint8_t value) { cells[address % EEPROM_SHIM_SIZE] = value; writes++; }
+    void update(int address, uint8_t value) { if(read(address) != value) write(address, value); }
+    uint16_t length(void) { return EEPROM_SHIM_SIZE; }
+    void clear(void) { memset(cells, 0xFF, sizeof(cells)); }
+    unsigned long writes;
+  private:
+    uint8_t cells[EEPROM_SHIM_SIZE];
+};
+
+extern EEPROMClass EEPROM;
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef _SOFTWARE_SERIAL_SHIM_H
+#define _SOFTWARE_SERIAL_SHIM_H
+
+#include <Arduino.h>
+
+// nothing is wired on the host: writes are dropped and nothing comes back,
+// use an ObdTransport such as the ELM327 simulator instead
+class SoftwareSerial : public Stream {
+  public:
+    SoftwareSerial(uint8_t rxPin, uint8_t txPin) { (void)rxPin; (void)txPin; }
+    void begin(long baud) { (void)baud; }
+    void end(void) {}
+    bool listen(void) { return true; }
+    int available() { return 0; }
+    int read() { return -1; }
+    int peek() { return -1; }
+    size_t write(uint8_t value) { (void)value; return 1; }
+    using Print::write;
+};
+
+#endif
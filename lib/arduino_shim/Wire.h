@@ -0,0 +1,34 @@
+#ifndef _WIRE_SHIM_H
+#define _WIRE_SHIM_H
+
+#include <Arduino.h>
+
+#define WIRE_SHIM_BUFFER 32
+
+// I2C master that delivers each transmission to an optional listener and
+// counts the traffic, as the AVR Wire it holds at most 32 bytes per
+// transmission
+typedef void (*wire_listener_t)(uint8_t address, const uint8_t* data, uint8_t length);
+
+class TwoWire {
+  public:
+    TwoWire() : listener(NULL), bytesSent(0), transmissions(0), length(0) {}
+    void begin(void) {}
+    void setClock(uint32_t clock) { (void)clock; }
+    void beginTransmission(uint8_t address) { target = address; length = 0; }
+    size_t write(uint8_t value);
+    uint8_t endTransmission(bool stop = true);
+    void onTransmission(wire_listener_t callback) { listener = callback; }
+    wire_listener_t listener;
+    // address and data bytes, as they go on the bus
+    unsigned long bytesSent;
+    unsigned long transmissions;
+  private:
+    uint8_t target;
+    uint8_t buffer[WIRE_SHIM_BUFFER];
+    uint8_t length;
+};
+
+extern TwoWire Wire;
+
+#endif
@@ -0,0 +1,86 @@
+#include <Arduino.h>
+
+HardwareSerial Serial;
+
+static unsigned long long clockMicros = 0;
+static unsigned long callCost = 1;
+
+unsigned long micros() {
+  clockMicros += callCost;
+  return (unsigned long)clockMicros;
+}
+
+unsigned long millis() {
+  clockMicros += callCost;
+  return (unsigned long)(clockMicros / 1000);
+}
+
+void delay(unsigned long ms) {
+  clockMicros += (unsigned long long)ms * 1000;
+}
+
+void delayMicroseconds(unsigned int us) {
+  clockMicros += us;
+}
+
+void arduinoShimAdvance(unsigned long us) {
+  clockMicros += us;
+}
+
+void arduinoShimSetCallCost(unsigned long us) {
+  callCost = us;
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+  (void)pin;
+  (void)mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+  (void)pin;
+  (void)value;
+}
+
+int digitalRead(uint8_t pin) {
+  (void)pin;
+  return HIGH;
+}
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+  size_t written = 0;
+  while(size--) written += write(*buffer++);
+  return written;
+}
+
+size_t Print::print(long value, int base) {
+  if(base == DEC) {
+    char text[24];
+    snprintf(text, sizeof(text), "%ld", value);
+    return write(text);
+  }
+  return print((unsigned long)value, base);
+}
+
+size_t Print::print(unsigned long value, int base) {
+  char text[8 * sizeof(long) + 1];
+  char* digit = text + sizeof(text) - 1;
+  *digit = '\0';
+  if(base < 2) base = 10;
+  do {
+    uint8_t rest = value % base;
+    *--digit = rest < 10 ? '0' + rest : 'A' + rest - 10;
+    value /= base;
+  } while(value);
+  return write(digit);
+}
+
+size_t Print::print(double value, int digits) {
+  char text[40];
+  snprintf(text, sizeof(text), "%.*f", digits, value);
+  return write(text);
+}
+
+String::String(const char* str) {
+  strncpy(buffer, str == NULL ? "" : str, sizeof(buffer) - 1);
+  buffer[sizeof(buffer) - 1] = '\0';
+}
@@ -0,0 +1,18 @@
+#include <Wire.h>
+
+TwoWire Wire;
+
+size_t TwoWire::write(uint8_t value) {
+  if(length >= WIRE_SHIM_BUFFER) return 0;
+  buffer[length++] = value;
+  return 1;
+}
+
+uint8_t TwoWire::endTransmission(bool stop) {
+  (void)stop;
+  bytesSent += 1 + length;
+  transmissions++;
+  if(listener != NULL) listener(target, buffer, length);
+  length = 0;
+  return 0;
+}
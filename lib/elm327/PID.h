@@ -6,134 +6,142 @@
 #ifndef PID_h
 #define PID_h
 
+#include <pidScale.h>
+
 // TODO: Implement all of these eventually.
 // See https://en.wikipedia.org/wiki/OBD-II_PIDs#Mode_1_PID_03 for more info
+//
+// Every mode 01 PID is listed once as X(name, pid, data bytes, scaling).
+// The list expands into the PID_* constants below and into the decoder
+// table in pidDecoder.cpp. A byte count of 0 means the PID is known but
+// its answer layout is not described yet, so it can't be decoded.
 
-#define PID_FUEL_SYSTEM_STATUS            "01 03" // Bit Encoded
-#define PID_CALCULATED_ENGINE_LOAD        "01 04" // A*100/255
-#define PID_COOLANT_TEMP                  "01 05" // Implemented
-#define PID_SHORTTERM_FUEL_TRIM_1         "01 06" // (A-128) * 100/128
-#define PID_LONGTERM_FUEL_TRIM_1          "01 07" // (A-128) * 100/128
-#define PID_SHORTTERM_FUEL_TRIM_2         "01 08" // (A-128) * 100/128
-#define PID_LONGTERM_FUEL_TRIM_2          "01 09" // (A-128) * 100/128
-#define PID_FUEL_PRESSURE                 "01 0A" // A*3
-#define PID_INTAKE_MANIFOLD_ABS_PRESSURE  "01 0B" // A
-#define PID_RPM                           "01 0C" // Implemented
-#define PID_SPEED                         "01 0D" // Implemented
-#define PID_TIMING_ADVANCE                "01 0E" // (A-128)/2
-#define PID_IAT_TEMP                      "01 0F" // Implemented
-#define PID_AIR_FLOW_RATE                 "01 10" // Implemented
-#define PID_THROTTLE                      "01 11" // Implemented
-#define PID_COMMANDED_SECONDARY_AIR       "01 12" // Bit Encoded
-
-// These are a special case. A contains oxygen sensor, B contains fuel trim.
-#define PID_OXYGEN_SENSOR_VOLTAGE_B1_S1   "01 14" // A/200
-#define PID_OXYGEN_SENSOR_VOLTAGE_B1_S2   "01 15" // A/200
-#define PID_OXYGEN_SENSOR_VOLTAGE_B1_S3   "01 16" // A/200
-#define PID_OXYGEN_SENSOR_VOLTAGE_B1_S4   "01 17" // A/200
-#define PID_OXYGEN_SENSOR_VOLTAGE_B2_S1   "01 18" // A/200
-#define PID_OXYGEN_SENSOR_VOLTAGE_B2_S2   "01 19" // A/200
-#define PID_OXYGEN_SENSOR_VOLTAGE_B2_S3   "01 1A" // A/200
-#define PID_OXYGEN_SENSOR_VOLTAGE_B2_S4   "01 1B" // A/200
-
-#define PID_FUEL_TRIM_B1_S1               "01 14" // (B-128) * 100/128 (if B==$FF, sensor is not used in trim calc)
-#define PID_FUEL_TRIM_B1_S2               "01 15" // (B-128) * 100/128 (if B==$FF, sensor is not used in trim calc)
-#define PID_FUEL_TRIM_B1_S3               "01 16" // (B-128) * 100/128 (if B==$FF, sensor is not used in trim calc)
-#define PID_FUEL_TRIM_B1_S4               "01 17" // (B-128) * 100/128 (if B==$FF, sensor is not used in trim calc)
-#define PID_FUEL_TRIM_B1_S5               "01 18" // (B-128) * 100/128 (if B==$FF, sensor is not used in trim calc)
-#define PID_FUEL_TRIM_B1_S6               "01 19" // (B-128) * 100/128 (if B==$FF, sensor is not used in trim calc)
-#define PID_FUEL_TRIM_B1_S7               "01 1A" // (B-128) * 100/128 (if B==$FF, sensor is not used in trim calc)
-#define PID_FUEL_TRIM_B1_S8               "01 1B" // (B-128) * 100/128 (if B==$FF, sensor is not used in trim calc)
-// End Special Case.
-
-#define PID_AUX_INPUT_STATUS              "01 1E" // "A0 == Power Take Off (PTO) status (1 == active) [A1..A7] not used"
-#define PID_RUNTIME_SINCE_ENGINE_START    "01 1F" // (A*256)+B
-
-#define PID_DISTANCE_TRAVELED_WITH_CEL    "01 21" // (A*256)+B
-#define PID_FUEL_RAIL_PRESSURE_VACUUM     "01 22" // ((A*256)+B) * 0.079
-#define PID_FUEL_RAIL_PRESSURE_DIRECT     "01 23" // ((A*256)+B) * 10
-
-// 24 to 2B  (Lambda Sensors) are a special case that need expanded once implemented.
-
-#define PID_COMMANDED_EGR                 "01 2C" // A*100/255
-#define PID_EGR_ERROR                     "01 2D" // (A-128) * 100/128
-#define PID_COMMANDED_EVAPORATIVE_PURGE   "01 2E" // A*100/255
-#define PID_FUEL_LEVEL_INPUT              "01 2F" // A*100/255
-#define PID_WARMUPS_SINCE_CODES_CLEARED   "01 30" // A
-#define PID_DISTANCE_SINCE_CODES_CLEARED  "01 31" // (A*256)+B
-#define PID_EVAP_SYSTEM_VAPOR_PRESSURE    "01 32" // ((A*256)+B)/4 (A and B are two's complementsigned)
-#define PID_BAROMETRIC_PRESSURE           "01 33" // Implemented
-#define PID_AMBIENT_TEMP                  "01 46" // Implemented
-
-#define PID_MONITOR_STATUS_THIS_DRIVE_CYCLE       "01 41" // Bit encoded. See below
-#define PID_CONTROL_MODULE_VOLTAGE                "01 42" // ((A*256)+B)/1000
-#define PID_ABSOLUTE_LOAD_VALUE                   "01 43" // ((A*256)+B)*100/255
-#define PID_FUEL_AIR_COMMANDED_EQUIVALENCE_RATIO  "01 44" // ((A*256)+B)/32768
-#define PID_RELATIVE_THROTTLE_POSITION            "01 45" // A*100/255
-#define PID_AMBIENT_AIR_TEMP                      "01 46" // A-40
-#define PID_ABSOLUTE_THROTTLE_POSITION_B          "01 47" // A*100/255
-#define PID_ABSOLUTE_THROTTLE_POSITION_C          "01 48" // A*100/255
-#define PID_ACCELERATOR_PEDAL_POSITION_D          "01 49" // A*100/255
-#define PID_ACCELERATOR_PEDAL_POSITION_E          "01 4A" // A*100/255
-#define PID_ACCELERATOR_PEDAL_POSITION_F          "01 4B" // A*100/255
-#define PID_COMMANDED_THROTTLE_ACTUATOR           "01 4C" // A*100/255
-#define PID_TIME_RUN_WITH_MIL_ON                  "01 4D" // (A*256)+B
-#define PID_TIME_SINCE_TROUBLE_CODES_CLEARED      "01 4E" // (A*256)+B
-
-// This is a special case that needs expanded once implemented.
-#define PID_MAXIMUM_VALUE_FOR_EQUIVALENCE_RATIO   "01 4F" // _OXYGEN_SENSOR_VOLTAGE,_OXYGEN_SENSOR_CURRENT,_AND_INTAKE_MANIFOLD_ABSOLUTE_PRESSURE "01 4F" // A, B, C, D*10
-
-#define PID_MAXIMUM_VALUE_FOR_AIR_FLOW_RATE_FROM_MASS_AIR_FLOW_SENSOR "01 50" // A*10, B, C, and D are reserved for future use
-#define PID_FUEL_TYPE                                                "01 51" // From fuel type table see below
-#define PID_ETHANOL_FUEL_PERCENTAGE                                  "01 52" // A*100/255
-#define PID_ABSOLUTE_EVAP_SYSTEM_VAPOR_PRESSURE                      "01 53" // ((A*256)+B)/200
-#define PID_SHORTTERM_SECONDARY_OXYGEN_SENSOR_TRIM_BANK_1_AND_BANK_3 "01 55" // (A-128)*100/128 (B-128)*100/128
-#define PID_LONGTERM_SECONDARY_OXYGEN_SENSOR_TRIM_BANK_1_AND_BANK_3  "01 56" // (A-128)*100/128 (B-128)*100/128
-#define PID_SHORTTERM_SECONDARY_OXYGEN_SENSOR_TRIM_BANK_2_AND_BANK_4 "01 57" // (A-128)*100/128 (B-128)*100/128
-#define PID_LONGTERM_SECONDARY_OXYGEN_SENSOR_TRIM_BANK_2_AND_BANK_4  "01 58" // (A-128)*100/128 (B-128)*100/128
-#define PID_FUEL_RAIL_PRESSURE_ABSOLUTE                              "01 59" // ((A*256)+B) * 10
-#define PID_RELATIVE_ACCELERATOR_PEDAL_POSITION                      "01 5A" // A*100/255
-#define PID_HYBRID_BATTERY_PACK_REMAINING_LIFE                       "01 5B" // A*100/255
-#define PID_ENGINE_OIL_TEMP                                          "01 5C" // A - 40
-#define PID_FUEL_INJECTION_TIMING                                    "01 5D" // (((A*256)+B)-26,880)/128
-#define PID_ENGINE_FUEL_RATE                                         "01 5E" // ((A*256)+B)*0.05
-#define PID_EMISSION_REQUIREMENTS_TO_WHICH_VEHICLE_IS_DESIGNED       "01 5F" // Bit Encoded
-#define PID_DEMAND_ENGINE_PERCENT_TORQUE                             "01 61" // A-125
-#define PID_ACTUAL_ENGINE_PERCENT_TORQUE                             "01 62" // A-125
-#define PID_ENGINE_REFERENCE_TORQUE                                  "01 63" // A*256+B
-#define PID_ENGINE_PERCENT_TORQUE_DATA                               "01 64" // A-125 Idle B-125 Engine point 1 C-125 Engine point 2 D-125 Engine point 3 E-125 Engine point 4"
-#define PID_AUXILIARY_IO_SUPPORTED                                   "01 65" // Bit Encoded
-#define PID_MASS_AIR_FLOW_SENSOR                                     "01 66" //
-#define PID_ENGINE_COOLANT_TEMP                                      "01 67" //
-#define PID_INTAKE_AIR_TEMP_SENSOR                                   "01 68" //
-#define PID_COMMANDED_EGR_AND_EGR_ERROR                              "01 69" //
-#define PID_COMMANDED_DIESEL_INTAKE_AIR_FLOW_CONTROL_AND_RELATIVE_INTAKE_AIR_FLOW_POSITION "01 6A" //
-#define PID_EXHAUST_GAS_RECIRCULATION_TEMP                           "01 6B" //
-#define PID_COMMANDED_THROTTLE_ACTUATOR_CONTROL_AND_RELATIVE_THROTTLE_POSITION "01 6C" //
-#define PID_FUEL_PRESSURE_CONTROL_SYSTEM                             "01 6D" //
-#define PID_INJECTION_PRESSURE_CONTROL_SYSTEM                        "01 6E" //
-#define PID_TURBOCHARGER_COMPRESSOR_INLET_PRESSURE                   "01 6F" //
-#define PID_BOOST_PRESSURE_CONTROL                                   "01 70" //
-#define PID_VARIABLE_GEOMETRY_TURBO_CONTROL                          "01 71" //
-#define PID_WASTEGATE_CONTROL                                        "01 72" //
-#define PID_EXHAUST_PRESSURE                                         "01 73" //
-#define PID_TURBOCHARGER_RPM                                         "01 74" //
-#define PID_TURBOCHARGER_TEMP                                        "01 75" //
-#define PID_CHARGE_AIR_COOLER_TEMP                                   "01 77" //
-#define PID_EXHAUST_GAS_TEMP_BANK_1                                  "01 78" // Special PID. See below
-#define PID_EXHAUST_GAS_TEMP_BANK_2                                  "01 79" // Special PID. See below
-#define PID_DIESEL_PARTICULATE_FILTER                                "01 7A" //
-#define PID_DIESEL_PARTICULATE_FILTER_TEMP                           "01 7C" //
-#define PID_NOX_NTE_CONTROL_AREA_STATUS                              "01 7D" //
-#define PID_PM_NTE_CONTROL_AREA_STATUS                               "01 7E" //
-#define PID_ENGINE_RUN_TIME                                          "01 7F" //
-
-#define PID_ENGINE_RUN_TIME_FOR_AUXILIARY_EMISSIONS_CONTROL_DEVICE   "01 81" //
-#define PID_NOX_SENSOR                                               "01 83" //
-#define PID_MANIFOLD_SURFACE_TEMP                                    "01 84" //
-#define PID_NOX_REAGENT_SYSTEM                                       "01 85" //
-#define PID_PARTICULATE_MATTER_SENSOR                                "01 86" //
-#define PID_INTAKE_MANIFOLD_ABSOLUTE_PRESSURE                        "01 87" //
+#define OBD_PID_LIST(X) \
+  X(SUPPORTED_PIDS_01_20,             0x00, 4, PID_SCALE_RAW)          /* Bit Encoded */ \
+  X(MONITOR_STATUS_SINCE_DTC_CLEARED, 0x01, 4, PID_SCALE_RAW)          /* Bit Encoded */ \
+  X(FUEL_SYSTEM_STATUS,               0x03, 2, PID_SCALE_RAW)          /* Bit Encoded */ \
+  X(CALCULATED_ENGINE_LOAD,           0x04, 1, PID_SCALE_A_PERCENT)    /* A*100/255 */ \
+  X(COOLANT_TEMP,                     0x05, 1, PID_SCALE_A_MINUS_40)   /* A-40 */ \
+  X(SHORTTERM_FUEL_TRIM_1,            0x06, 1, PID_SCALE_A_TRIM)       /* (A-128) * 100/128 */ \
+  X(LONGTERM_FUEL_TRIM_1,             0x07, 1, PID_SCALE_A_TRIM)       /* (A-128) * 100/128 */ \
+  X(SHORTTERM_FUEL_TRIM_2,            0x08, 1, PID_SCALE_A_TRIM)       /* (A-128) * 100/128 */ \
+  X(LONGTERM_FUEL_TRIM_2,             0x09, 1, PID_SCALE_A_TRIM)       /* (A-128) * 100/128 */ \
+  X(FUEL_PRESSURE,                    0x0A, 1, PID_SCALE_A_X3)         /* A*3 */ \
+  X(INTAKE_MANIFOLD_ABS_PRESSURE,     0x0B, 1, PID_SCALE_A)            /* A */ \
+  X(RPM,                              0x0C, 2, PID_SCALE_AB_DIV_4)     /* ((A*256)+B)/4 */ \
+  X(SPEED,                            0x0D, 1, PID_SCALE_A)            /* A */ \
+  X(TIMING_ADVANCE,                   0x0E, 1, PID_SCALE_A_TIMING)     /* (A-128)/2 */ \
+  X(IAT_TEMP,                         0x0F, 1, PID_SCALE_A_MINUS_40)   /* A-40 */ \
+  X(AIR_FLOW_RATE,                    0x10, 2, PID_SCALE_AB_DIV_100)   /* ((A*256)+B)/100 */ \
+  X(THROTTLE,                         0x11, 1, PID_SCALE_A_PERCENT)    /* A*100/255 */ \
+  X(COMMANDED_SECONDARY_AIR,          0x12, 1, PID_SCALE_RAW)          /* Bit Encoded */ \
+  /* These are a special case. A contains oxygen sensor, B contains fuel trim. */ \
+  X(OXYGEN_SENSOR_VOLTAGE_B1_S1,      0x14, 2, PID_SCALE_A_DIV_200)    /* A/200 */ \
+  X(OXYGEN_SENSOR_VOLTAGE_B1_S2,      0x15, 2, PID_SCALE_A_DIV_200)    /* A/200 */ \
+  X(OXYGEN_SENSOR_VOLTAGE_B1_S3,      0x16, 2, PID_SCALE_A_DIV_200)    /* A/200 */ \
+  X(OXYGEN_SENSOR_VOLTAGE_B1_S4,      0x17, 2, PID_SCALE_A_DIV_200)    /* A/200 */ \
+  X(OXYGEN_SENSOR_VOLTAGE_B2_S1,      0x18, 2, PID_SCALE_A_DIV_200)    /* A/200 */ \
+  X(OXYGEN_SENSOR_VOLTAGE_B2_S2,      0x19, 2, PID_SCALE_A_DIV_200)    /* A/200 */ \
+  X(OXYGEN_SENSOR_VOLTAGE_B2_S3,      0x1A, 2, PID_SCALE_A_DIV_200)    /* A/200 */ \
+  X(OXYGEN_SENSOR_VOLTAGE_B2_S4,      0x1B, 2, PID_SCALE_A_DIV_200)    /* A/200 */ \
+  X(AUX_INPUT_STATUS,                 0x1E, 1, PID_SCALE_RAW)          /* A0 == Power Take Off (PTO) status */ \
+  X(RUNTIME_SINCE_ENGINE_START,       0x1F, 2, PID_SCALE_AB)           /* (A*256)+B */ \
+  X(SUPPORTED_PIDS_21_40,             0x20, 4, PID_SCALE_RAW)          /* Bit Encoded */ \
+  X(DISTANCE_TRAVELED_WITH_CEL,       0x21, 2, PID_SCALE_AB)           /* (A*256)+B */ \
+  X(FUEL_RAIL_PRESSURE_VACUUM,        0x22, 2, PID_SCALE_AB_X0079)     /* ((A*256)+B) * 0.079 */ \
+  X(FUEL_RAIL_PRESSURE_DIRECT,        0x23, 2, PID_SCALE_AB_X10)       /* ((A*256)+B) * 10 */ \
+  /* 24 to 2B  (Lambda Sensors) are a special case that need expanded once implemented. */ \
+  X(COMMANDED_EGR,                    0x2C, 1, PID_SCALE_A_PERCENT)    /* A*100/255 */ \
+  X(EGR_ERROR,                        0x2D, 1, PID_SCALE_A_TRIM)       /* (A-128) * 100/128 */ \
+  X(COMMANDED_EVAPORATIVE_PURGE,      0x2E, 1, PID_SCALE_A_PERCENT)    /* A*100/255 */ \
+  X(FUEL_LEVEL_INPUT,                 0x2F, 1, PID_SCALE_A_PERCENT)    /* A*100/255 */ \
+  X(WARMUPS_SINCE_CODES_CLEARED,      0x30, 1, PID_SCALE_A)            /* A */ \
+  X(DISTANCE_SINCE_CODES_CLEARED,     0x31, 2, PID_SCALE_AB)           /* (A*256)+B */ \
+  X(EVAP_SYSTEM_VAPOR_PRESSURE,       0x32, 2, PID_SCALE_AB_SIGNED_DIV_4) /* ((A*256)+B)/4 (two's complement signed) */ \
+  X(BAROMETRIC_PRESSURE,              0x33, 1, PID_SCALE_A)            /* A */ \
+  X(SUPPORTED_PIDS_41_60,             0x40, 4, PID_SCALE_RAW)          /* Bit Encoded */ \
+  X(MONITOR_STATUS_THIS_DRIVE_CYCLE,  0x41, 4, PID_SCALE_RAW)          /* Bit encoded */ \
+  X(CONTROL_MODULE_VOLTAGE,           0x42, 2, PID_SCALE_AB_DIV_1000)  /* ((A*256)+B)/1000 */ \
+  X(ABSOLUTE_LOAD_VALUE,              0x43, 2, PID_SCALE_AB_PERCENT)   /* ((A*256)+B)*100/255 */ \
+  X(FUEL_AIR_COMMANDED_EQUIVALENCE_RATIO, 0x44, 2, PID_SCALE_AB_DIV_32768) /* ((A*256)+B)/32768 */ \
+  X(RELATIVE_THROTTLE_POSITION,       0x45, 1, PID_SCALE_A_PERCENT)    /* A*100/255 */ \
+  X(AMBIENT_AIR_TEMP,                 0x46, 1, PID_SCALE_A_MINUS_40)   /* A-40 */ \
+  X(ABSOLUTE_THROTTLE_POSITION_B,     0x47, 1, PID_SCALE_A_PERCENT)    /* A*100/255 */ \
+  X(ABSOLUTE_THROTTLE_POSITION_C,     0x48, 1, PID_SCALE_A_PERCENT)    /* A*100/255 */ \
+  X(ACCELERATOR_PEDAL_POSITION_D,     0x49, 1, PID_SCALE_A_PERCENT)    /* A*100/255 */ \
+  X(ACCELERATOR_PEDAL_POSITION_E,     0x4A, 1, PID_SCALE_A_PERCENT)    /* A*100/255 */ \
+  X(ACCELERATOR_PEDAL_POSITION_F,     0x4B, 1, PID_SCALE_A_PERCENT)    /* A*100/255 */ \
+  X(COMMANDED_THROTTLE_ACTUATOR,      0x4C, 1, PID_SCALE_A_PERCENT)    /* A*100/255 */ \
+  X(TIME_RUN_WITH_MIL_ON,             0x4D, 2, PID_SCALE_AB)           /* (A*256)+B */ \
+  X(TIME_SINCE_TROUBLE_CODES_CLEARED, 0x4E, 2, PID_SCALE_AB)           /* (A*256)+B */ \
+  /* This is a special case that needs expanded once implemented. */ \
+  X(MAXIMUM_VALUE_FOR_EQUIVALENCE_RATIO, 0x4F, 4, PID_SCALE_A)         /* A, B, C, D*10 */ \
+  X(MAXIMUM_VALUE_FOR_AIR_FLOW_RATE_FROM_MASS_AIR_FLOW_SENSOR, 0x50, 4, PID_SCALE_A_X10) /* A*10, B, C, and D are reserved */ \
+  X(FUEL_TYPE,                        0x51, 1, PID_SCALE_RAW)          /* From fuel type table */ \
+  X(ETHANOL_FUEL_PERCENTAGE,          0x52, 1, PID_SCALE_A_PERCENT)    /* A*100/255 */ \
+  X(ABSOLUTE_EVAP_SYSTEM_VAPOR_PRESSURE, 0x53, 2, PID_SCALE_AB_DIV_200) /* ((A*256)+B)/200 */ \
+  X(SHORTTERM_SECONDARY_OXYGEN_SENSOR_TRIM_BANK_1_AND_BANK_3, 0x55, 2, PID_SCALE_A_TRIM) /* (A-128)*100/128 (B-128)*100/128 */ \
+  X(LONGTERM_SECONDARY_OXYGEN_SENSOR_TRIM_BANK_1_AND_BANK_3,  0x56, 2, PID_SCALE_A_TRIM) /* (A-128)*100/128 (B-128)*100/128 */ \
+  X(SHORTTERM_SECONDARY_OXYGEN_SENSOR_TRIM_BANK_2_AND_BANK_4, 0x57, 2, PID_SCALE_A_TRIM) /* (A-128)*100/128 (B-128)*100/128 */ \
+  X(LONGTERM_SECONDARY_OXYGEN_SENSOR_TRIM_BANK_2_AND_BANK_4,  0x58, 2, PID_SCALE_A_TRIM) /* (A-128)*100/128 (B-128)*100/128 */ \
+  X(FUEL_RAIL_PRESSURE_ABSOLUTE,      0x59, 2, PID_SCALE_AB_X10)       /* ((A*256)+B) * 10 */ \
+  X(RELATIVE_ACCELERATOR_PEDAL_POSITION, 0x5A, 1, PID_SCALE_A_PERCENT) /* A*100/255 */ \
+  X(HYBRID_BATTERY_PACK_REMAINING_LIFE, 0x5B, 1, PID_SCALE_A_PERCENT)  /* A*100/255 */ \
+  X(ENGINE_OIL_TEMP,                  0x5C, 1, PID_SCALE_A_MINUS_40)   /* A - 40 */ \
+  X(FUEL_INJECTION_TIMING,            0x5D, 2, PID_SCALE_AB_INJECTION) /* (((A*256)+B)-26,880)/128 */ \
+  X(ENGINE_FUEL_RATE,                 0x5E, 2, PID_SCALE_AB_X005)      /* ((A*256)+B)*0.05 */ \
+  X(EMISSION_REQUIREMENTS_TO_WHICH_VEHICLE_IS_DESIGNED, 0x5F, 1, PID_SCALE_RAW) /* Bit Encoded */ \
+  X(SUPPORTED_PIDS_61_80,             0x60, 4, PID_SCALE_RAW)          /* Bit Encoded */ \
+  X(DEMAND_ENGINE_PERCENT_TORQUE,     0x61, 1, PID_SCALE_A_MINUS_125)  /* A-125 */ \
+  X(ACTUAL_ENGINE_PERCENT_TORQUE,     0x62, 1, PID_SCALE_A_MINUS_125)  /* A-125 */ \
+  X(ENGINE_REFERENCE_TORQUE,          0x63, 2, PID_SCALE_AB)           /* A*256+B */ \
+  X(ENGINE_PERCENT_TORQUE_DATA,       0x64, 5, PID_SCALE_A_MINUS_125)  /* A-125 Idle B-125 Engine point 1 ... E-125 Engine point 4 */ \
+  X(AUXILIARY_IO_SUPPORTED,           0x65, 2, PID_SCALE_RAW)          /* Bit Encoded */ \
+  X(MASS_AIR_FLOW_SENSOR,             0x66, 0, PID_SCALE_RAW) \
+  X(ENGINE_COOLANT_TEMP,              0x67, 0, PID_SCALE_RAW) \
+  X(INTAKE_AIR_TEMP_SENSOR,           0x68, 0, PID_SCALE_RAW) \
+  X(COMMANDED_EGR_AND_EGR_ERROR,      0x69, 0, PID_SCALE_RAW) \
+  X(COMMANDED_DIESEL_INTAKE_AIR_FLOW_CONTROL_AND_RELATIVE_INTAKE_AIR_FLOW_POSITION, 0x6A, 0, PID_SCALE_RAW) \
+  X(EXHAUST_GAS_RECIRCULATION_TEMP,   0x6B, 0, PID_SCALE_RAW) \
+  X(COMMANDED_THROTTLE_ACTUATOR_CONTROL_AND_RELATIVE_THROTTLE_POSITION, 0x6C, 0, PID_SCALE_RAW) \
+  X(FUEL_PRESSURE_CONTROL_SYSTEM,     0x6D, 0, PID_SCALE_RAW) \
+  X(INJECTION_PRESSURE_CONTROL_SYSTEM, 0x6E, 0, PID_SCALE_RAW) \
+  X(TURBOCHARGER_COMPRESSOR_INLET_PRESSURE, 0x6F, 0, PID_SCALE_RAW) \
+  X(BOOST_PRESSURE_CONTROL,           0x70, 0, PID_SCALE_RAW) \
+  X(VARIABLE_GEOMETRY_TURBO_CONTROL,  0x71, 0, PID_SCALE_RAW) \
+  X(WASTEGATE_CONTROL,                0x72, 0, PID_SCALE_RAW) \
+  X(EXHAUST_PRESSURE,                 0x73, 0, PID_SCALE_RAW) \
+  X(TURBOCHARGER_RPM,                 0x74, 0, PID_SCALE_RAW) \
+  X(TURBOCHARGER_TEMP,                0x75, 0, PID_SCALE_RAW) \
+  X(CHARGE_AIR_COOLER_TEMP,           0x77, 0, PID_SCALE_RAW) \
+  X(EXHAUST_GAS_TEMP_BANK_1,          0x78, 0, PID_SCALE_RAW)          /* Special PID */ \
+  X(EXHAUST_GAS_TEMP_BANK_2,          0x79, 0, PID_SCALE_RAW)          /* Special PID */ \
+  X(DIESEL_PARTICULATE_FILTER,        0x7A, 0, PID_SCALE_RAW) \
+  X(DIESEL_PARTICULATE_FILTER_TEMP,   0x7C, 0, PID_SCALE_RAW) \
+  X(NOX_NTE_CONTROL_AREA_STATUS,      0x7D, 0, PID_SCALE_RAW) \
+  X(PM_NTE_CONTROL_AREA_STATUS,       0x7E, 0, PID_SCALE_RAW) \
+  X(ENGINE_RUN_TIME,                  0x7F, 0, PID_SCALE_RAW) \
+  X(ENGINE_RUN_TIME_FOR_AUXILIARY_EMISSIONS_CONTROL_DEVICE, 0x81, 0, PID_SCALE_RAW) \
+  X(NOX_SENSOR,                       0x83, 0, PID_SCALE_RAW) \
+  X(MANIFOLD_SURFACE_TEMP,            0x84, 0, PID_SCALE_RAW) \
+  X(NOX_REAGENT_SYSTEM,               0x85, 0, PID_SCALE_RAW) \
+  X(PARTICULATE_MATTER_SENSOR,        0x86, 0, PID_SCALE_RAW) \
+  X(INTAKE_MANIFOLD_ABSOLUTE_PRESSURE, 0x87, 0, PID_SCALE_RAW)
 
+#define OBD_PID_ENUM(name, pid, bytes, scale) PID_##name = pid,
+enum {
+  OBD_PID_LIST(OBD_PID_ENUM)
+  // same PIDs as the oxygen sensor voltages, B holds the fuel trim
+  PID_FUEL_TRIM_B1_S1 = PID_OXYGEN_SENSOR_VOLTAGE_B1_S1,
+  PID_FUEL_TRIM_B1_S2 = PID_OXYGEN_SENSOR_VOLTAGE_B1_S2,
+  PID_FUEL_TRIM_B1_S3 = PID_OXYGEN_SENSOR_VOLTAGE_B1_S3,
+  PID_FUEL_TRIM_B1_S4 = PID_OXYGEN_SENSOR_VOLTAGE_B1_S4,
+  PID_FUEL_TRIM_B1_S5 = PID_OXYGEN_SENSOR_VOLTAGE_B2_S1,
+  PID_FUEL_TRIM_B1_S6 = PID_OXYGEN_SENSOR_VOLTAGE_B2_S2,
+  PID_FUEL_TRIM_B1_S7 = PID_OXYGEN_SENSOR_VOLTAGE_B2_S3,
+  PID_FUEL_TRIM_B1_S8 = PID_OXYGEN_SENSOR_VOLTAGE_B2_S4,
+  PID_AMBIENT_TEMP = PID_AMBIENT_AIR_TEMP
+};
+#undef OBD_PID_ENUM
 
 #endif
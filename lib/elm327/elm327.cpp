@@ -4,15 +4,16 @@ http://www.kokoras.com/OBD/Arduino_HC-05_ELM327_OBD_RPM_Shift_Light.htm
 */
 #include <Arduino.h>
 #include "elm327.h"
+#include "pidDecoder.h"
+#include "softSerialTransport.h"
 
 void printHex(const char*, uint8_t);
 
 error_code_t ObdReader::setup() {
-  pinMode(config.rxPin, INPUT);
-  pinMode(config.txPin, OUTPUT);
-
-  serial = new SoftwareSerial(config.rxPin, config.txPin);
+  serial = config.transport;
+  if(serial == NULL) serial = new SoftSerialTransport(config.rxPin, config.txPin);
   serial->begin(BAUDRATE);
+  linkBaud = BAUDRATE;
 
   resBuf = (char*) calloc(MAX_RESP_BUFFER, sizeof(char));
   resLength = 0;
@@ -24,87 +25,169 @@ void ObdReader::enable_debug(bool enabled) {
   debug_mode = enabled;
 }
 
-void ObdReader::debug(const char* message, bool new_line = true) {
-  if(debug_mode) {
-    new_line ? Serial.println(message) : Serial.print(message);
+void ObdReader::setLogOutput(Print* output) {
+  logOutput = output;
+}
+
+void ObdReader::log(const __FlashStringHelper* message, bool new_line) {
+  if(logOutput != NULL) {
+    new_line ? logOutput->println(message) : logOutput->print(message);
   }
 }
 
-void ObdReader::debug(const __FlashStringHelper* message, bool new_line = true) {
-  if(debug_mode) {
-    new_line ? Serial.println(message) : Serial.print(message);
+void ObdReader::debug(const char* message, bool new_line) {
+  if(debug_mode && logOutput != NULL) {
+    new_line ? logOutput->println(message) : logOutput->print(message);
   }
 }
 
-char* ObdReader::send_OBD_cmd(const char* obd_cmd, bool waitPrompt = true) {
-  char recvChar;
-  boolean prompt = false;
-  int retries = 0;
-  unsigned long time = millis();
-  bool spinlock = true;
-
-  while((!prompt) && (retries < OBD_CMD_RETRIES)) {                //while no prompt and not reached OBD cmd retries
-    memset(resBuf, 0, MAX_RESP_BUFFER);
-    resLength = 0;
-    debug(F("Sending command "), false);
-    debug(obd_cmd);
-    serial->print(obd_cmd);                             //send OBD cmd
-    serial->print("\r");                                //send cariage return
-
-    while(spinlock){
-      if(millis() > (time + 4000)){
-        break;
-      }
-      else if(serial->available()>0){
-        spinlock = false;
-      }
-    }
-    // if serial port still not available
-    // skip next instructions and make another cmd send attempt
-    if(spinlock) {
-      Serial.println(F("No bytes transferred. Send command again!"));
-      retries++;                                          //increase retries
-      delay(1000);
-      continue;
-    }
+void ObdReader::debug(const __FlashStringHelper* message, bool new_line) {
+  if(debug_mode) log(message, new_line);
+}
 
-    while ((serial->available()>0) && (!prompt)) {       //while there is data and not prompt
-      recvChar = serial->read();                        //read from elm
-      if (recvChar == 62) {
-        prompt = true;                            //if received char is '>' then prompt is true
-      }
-      // 13 correspond to '\r', 32 to ' '
-      else if(recvChar != 13 && recvChar != 32) resBuf[resLength++] = recvChar;
-    }
-    // exit the loop if we are not waiting for prompt
-    if(!waitPrompt) {
-      break;
-    }
-    if(!prompt) {
-      Serial.print(F("Get no prompt! Try again."));
-      retries++;                                          //increase retries
-      delay(1000);
-    }
+bool ObdReader::submit(const char* obd_cmd, obd_cmd_callback_t callback, void* ctx) {
+  return submitCmd(obd_cmd, false, callback, ctx);
+}
+
+bool ObdReader::submit(const __FlashStringHelper* obd_cmd, obd_cmd_callback_t callback, void* ctx) {
+  return submitCmd((const char*) obd_cmd, true, callback, ctx);
+}
+
+bool ObdReader::submitCmd(const char* obd_cmd, bool inFlash, obd_cmd_callback_t callback, void* ctx) {
+  if(busy()) return false;
+  pendingCmd = obd_cmd;
+  pendingCmdInFlash = inFlash;
+  pendingCallback = callback;
+  pendingCtx = ctx;
+  cmdRetries = 0;
+  sendPending();
+  return true;
+}
+
+void ObdReader::sendPending() {
+  // drop whatever is left from a previous timed out command
+  while(serial->available() > 0) serial->read();
+  memset(resBuf, 0, MAX_RESP_BUFFER);
+  resLength = 0;
+  debug(F("Sending command "), false);
+  if(pendingCmdInFlash) {
+    debug((const __FlashStringHelper*) pendingCmd);
+    serial->print((const __FlashStringHelper*) pendingCmd);  //send OBD cmd
   }
-  if(retries == OBD_CMD_RETRIES) {
-    Serial.print(F("Reached max attempt. Abort!"));
-    return NULL;
-  } else {
+  else {
+    debug(pendingCmd);
+    serial->print(pendingCmd);                          //send OBD cmd
+  }
+  serial->print("\r");                                 //send cariage return
+  cmdStamp = millis();
+  cmdState = OBD_CMD_WAITING;
+}
+
+void ObdReader::retryPending() {
+  cmdRetries++;                                         //increase retries
+  if(cmdRetries >= OBD_CMD_RETRIES) {
+    log(F("Reached max attempt. Abort!"), false);
+    complete(OBD_CMD_FAILED);
+    return;
+  }
+  cmdStamp = millis();
+  cmdState = OBD_CMD_BACKOFF;
+}
+
+obd_cmd_state_t ObdReader::complete(obd_cmd_state_t state) {
+  obd_cmd_callback_t callback = pendingCallback;
+  cmdState = state;
+  pendingCallback = NULL;
+  if(state == OBD_CMD_DONE) {
     debug(F("Response: "), false);
     debug(resBuf);
     printHex(resBuf, resLength);
-    return resBuf;
   }
+  if(batchPending) {
+    batchPending = false;
+    if(state == OBD_CMD_DONE) recordRoundTrip(millis() - cmdStamp);
+    uint8_t decoded = state == OBD_CMD_DONE ? decodePids() : 0;
+    // protocols other than CAN only answer the first PID of a batch,
+    // stop packing them once we see that
+    if(batchCount > 1 && decoded <= 1) {
+      debug(F("Batched PIDs not supported"));
+      batchLimit = 1;
+    }
+  }
+  // the callback is free to submit the next command
+  if(callback != NULL) callback(state, pendingCtx);
+  return state;
+}
+
+obd_cmd_state_t ObdReader::poll() {
+  char recvChar;
+
+  switch(cmdState) {
+    case OBD_CMD_BACKOFF:
+      if(millis() - cmdStamp >= OBD_RETRY_DELAY) sendPending();
+      break;
+
+    case OBD_CMD_WAITING:
+    case OBD_CMD_RECEIVING:
+      // only consume what is already there, never wait for more
+      while(serial->available() > 0) {
+        recvChar = serial->read();                      //read from elm
+        cmdState = OBD_CMD_RECEIVING;
+        if(recvChar == '>') {
+          return complete(OBD_CMD_DONE);
+        }
+        // strip spaces and keep a single '\r' between lines (multi frame
+        // answers need it), keep one char for the terminator
+        else if(recvChar == ' ' || recvChar == '\n') formattingBytes++;
+        else if(resLength >= MAX_RESP_BUFFER - 1) continue;
+        else if(recvChar != '\r' || (resLength > 0 && resBuf[resLength - 1] != '\r')) {
+          resBuf[resLength++] = recvChar;
+        }
+      }
+      if(cmdState == OBD_CMD_WAITING && millis() - cmdStamp > OBD_FIRST_BYTE_TIMEOUT) {
+        log(F("No bytes transferred. Send command again!"));
+        retryPending();
+      }
+      else if(cmdState == OBD_CMD_RECEIVING && millis() - cmdStamp > OBD_PROMPT_TIMEOUT) {
+        log(F("Get no prompt! Try again."), false);
+        retryPending();
+      }
+      break;
+
+    default:
+      break;
+  }
+  return cmdState;
+}
+
+bool ObdReader::busy() {
+  return cmdState == OBD_CMD_WAITING || cmdState == OBD_CMD_RECEIVING || cmdState == OBD_CMD_BACKOFF;
+}
+
+obd_cmd_state_t ObdReader::state() {
+  return cmdState;
+}
+
+char* ObdReader::send_OBD_cmd(const char* obd_cmd) {
+  if(!submit(obd_cmd)) return NULL;
+  while(busy()) poll();
+  return cmdState == OBD_CMD_DONE ? resBuf : NULL;
+}
+
+char* ObdReader::send_OBD_cmd(const __FlashStringHelper* obd_cmd) {
+  if(!submit(obd_cmd)) return NULL;
+  while(busy()) poll();
+  return cmdState == OBD_CMD_DONE ? resBuf : NULL;
 }
 
 void ObdReader::printHex(const char* str, uint8_t size) {
-  if(debug_mode) {
+  if(debug_mode && logOutput != NULL) {
     char hexStr[4] = {'\0'};
     for(int i = 0; i < size; i++) {
       sprintf(hexStr, "%x ", str[i]);
-      Serial.print(hexStr);
+      logOutput->print(hexStr);
     }
-    Serial.println(F(" END"));
+    logOutput->println(F(" END"));
   }
 }
 
@@ -121,84 +204,308 @@ error_code_t ObdReader::obd_init() {
   bool obdConnected = false;
   uint8_t nbRetry = 0;
 
-  if(send_OBD_cmd("ATZ") == NULL) return RESET_ERROR;      //send to OBD ATZ, reset
-  delay(1000);
-
-  if(send_OBD_cmd("ATE0") == NULL) return ECHO_OFF_ERROR;      //send to OBD ATE0, echo off
-  delay(5000);
+  // no fixed delays: every command returns as soon as the prompt shows up
+  // and a warm start skips the LED test of ATZ
+  if(send_OBD_cmd(F("ATWS")) == NULL) return RESET_ERROR;     //send to OBD ATWS, reset
+  if(send_OBD_cmd(F("ATE0")) == NULL) return ECHO_OFF_ERROR;      //send to OBD ATE0, echo off
 
+#if OBD_BAUD_NEGOTIATION
+  // a reset brings the adapter back to its default rate, so do it after
+  negotiateBaudRate();
+#endif
 
   while(!obdConnected) {
-    if(send_OBD_cmd("ATRV") == NULL) return GET_VOLTAGE_ERROR;      //read voltage to check if OBD is connected to car
+    if(send_OBD_cmd(F("ATRV")) == NULL) return GET_VOLTAGE_ERROR;      //read voltage to check if OBD is connected to car
     replaceStrChar('V', '\0');
     voltage = String(resBuf).toFloat();
     if(voltage < 6  && nbRetry == OBD_CMD_RETRIES) {
-      Serial.println(F("OBDII plug not connected"));
+      log(F("OBDII plug not connected"));
       return OBD_NOT_CONNECTED;
     }
     else {
       obdConnected = true;
     }
-    delay(1000);
     nbRetry++;
   }
 
-  //send ATSP0, protocol auto
-  if(send_OBD_cmd("ATSP0") == NULL) return SELECT_PROTOCOL_ERROR;
-  delay(1000);
+  // until the bitmap is known every PID is assumed to be supported
+  memset(supportedPids, 0, sizeof(supportedPids));
+  supportedPidsKnown = false;
+
+  error_code_t error = connectEcu();
+  if(error != NO_ERROR) return error;
 
-  if(send_OBD_cmd("0100") == NULL) return PID00_ERROR;     //send 0100, retrieve available pid's 00-19
-  delay(1000);
+  // each range tells whether the next one can be asked for
+  if(isPidSupported(0x20)) {
+    if(send_OBD_cmd(F("0120")) == NULL) return PID20_ERROR;   //send 0120, retrieve available pid's 21-40
+    decodeSupportedPids(0x20);
+  }
 
-  if(send_OBD_cmd("0120") == NULL) return PID20_ERROR;     //send 0120, retrieve available pid's 20-39
-  delay(1000);
+  if(isPidSupported(0x40)) {
+    if(send_OBD_cmd(F("0140")) == NULL) return PID40_ERROR;   //send 0140, retrieve available pid's 41-60
+    decodeSupportedPids(0x40);
+  }
 
-  if(send_OBD_cmd("0140") == NULL) return PID40_ERROR;     //send 0140, retrieve available pid's 40-??
-  delay(1000);
+  if(isPidSupported(0x60) && send_OBD_cmd(F("0160")) != NULL) {
+    decodeSupportedPids(0x60);                                //pid's 61-80
+  }
+
+  // not fatal, the adapter keeps working with its defaults
+  if(config.profile == OBD_PROFILE_LOW_LATENCY && !applyLowLatencyProfile()) {
+    log(F("Low latency profile not applied"));
+  }
 
   return NO_ERROR;
 }
 
+// Answers to 0100/0120/0140/0160 hold 32 bits, the MSB of the first byte
+// stands for base + 1 and the LSB of the last one for base + 0x20. When
+// several ECUs answer their bitmaps are merged.
+bool ObdReader::decodeSupportedPids(uint8_t base) {
+  uint8_t* range = supportedPids + base / 8;
+  bool found = false;
+  uint8_t i = 0;
+
+  while(i < resLength) {
+    uint8_t lineEnd = i;
+    while(lineEnd < resLength && resBuf[lineEnd] != '\r') lineEnd++;
+    if(lineEnd - i >= 12 && hexByte(resBuf + i) == 0x41 && hexByte(resBuf + i + 2) == base) {
+      for(uint8_t k = 0; k < 4; k++) {
+        int16_t bits = hexByte(resBuf + i + 4 + 2 * k);
+        if(bits >= 0) range[k] |= bits;
+      }
+      found = true;
+    }
+    i = lineEnd + 1;
+  }
+  return found;
+}
+
+bool ObdReader::isPidSupported(uint8_t pid) {
+  if(!supportedPidsKnown || pid == 0x00) return true;
+  if(pid > 8 * OBD_SUPPORTED_PID_BYTES) return false;
+  pid--;
+  return supportedPids[pid >> 3] & (0x80 >> (pid & 0x07));
+}
+
+bool ObdReader::requestPid(uint8_t pid, obd_cmd_callback_t callback, void* ctx) {
+  return submitPids(&pid, 1, callback, ctx);
+}
+
+bool ObdReader::requestRpm(obd_cmd_callback_t callback, void* ctx) {
+  return requestPid(PID_RPM, callback, ctx);
+}
+
+bool ObdReader::requestEngineCoolantTemp(obd_cmd_callback_t callback, void* ctx) {
+  return requestPid(PID_COOLANT_TEMP, callback, ctx);
+}
+
+bool ObdReader::getPid(uint8_t pid, int32_t* value) {
+  if(!queryPids(&pid, 1)) return false;
+  return parsePid(pid, value);
+}
+
 int ObdReader::getRpm() {
-  boolean valid = false;
-  int rpm = 0;
+  int32_t rpm = 0;
+  getPid(PID_RPM, &rpm);
+  return rpm / PID_FIXED_ONE;
+}
 
-  send_OBD_cmd("010C1", false);
+int ObdReader::getEngineCoolantTemp() {
+  int32_t temp = 0;
+  getPid(PID_COOLANT_TEMP, &temp);
+  return temp / PID_FIXED_ONE;
+}
 
-  valid = ((resBuf[0] == '4') && (resBuf[1] == '1') && (resBuf[2] == '0') && (resBuf[3] == 'C')); //if first four chars after our command is 410C
-  if (valid){                                                                    //in case of correct RPM response
-    char hexByte[2];
-    int A, B;
-    //start calculation of real RPM value
-    //RPM is coming from OBD in two 8bit(bytes) hex numbers for example A=0B and B=6C
-    //the equation is ((A * 256) + B) / 4, so 0B=11 and 6C=108
-    //so rpm=((11 * 256) + 108) / 4 = 731 a normal idle car engine rpm
-    memcpy(hexByte, resBuf + 4, 2);
-    A = strtol(hexByte, NULL, 16);
-    memcpy(hexByte, resBuf + 6, 2);
-    B = strtol(hexByte, NULL, 16);
-    rpm = ((A * 256) + B) / 4;
+bool ObdReader::parsePid(uint8_t pid, int32_t* value) {
+  pid_desc_t desc;
+  uint8_t data[2] = { 0, 0 };
+
+  //the answer of a single PID request is "41" followed by the PID and its
+  //data bytes, e.g. 410C0B6C for rpm = ((0x0B * 256) + 0x6C) / 4 = 731
+  if(!pidLookup(pid, &desc) || resLength < 4 + 2 * desc.bytes) return false;
+  if(hexByte(resBuf) != 0x41 || hexByte(resBuf + 2) != pid) return false;
+  for(uint8_t i = 0; i < desc.bytes && i < sizeof(data); i++) {
+    int16_t byte = hexByte(resBuf + 4 + 2 * i);
+    if(byte < 0) return false;
+    data[i] = byte;
   }
-  return rpm;
+  *value = pidScale(desc.scale, data);
+  return true;
 }
 
-int ObdReader::getEngineCoolantTemp() {
-  boolean valid = false;
-  int temp = 0;
-
-  send_OBD_cmd("01051", false);
-
-  valid = ((resBuf[0] == '4') && (resBuf[1] == '1') && (resBuf[2] == '0') && (resBuf[3] == '5'));
-  if (valid){                                                                    //in case of correct RPM response
-    char hexByte[2];
-    int A;
-    //start calculation of real RPM value
-    //RPM is coming from OBD in two 8bit(bytes) hex numbers for example A=0B and B=6C
-    //the equation is ((A * 256) + B) / 4, so 0B=11 and 6C=108
-    //so rpm=((11 * 256) + 108) / 4 = 731 a normal idle car engine rpm
-    memcpy(hexByte, resBuf + 4, 2);
-    A = strtol(hexByte, NULL, 16);
-    temp = A - 40;
-  }
-  return temp;
+int ObdReader::parseRpm() {
+  int32_t rpm = 0;
+  parsePid(PID_RPM, &rpm);
+  return rpm / PID_FIXED_ONE;
+}
+
+int ObdReader::parseEngineCoolantTemp() {
+  int32_t temp = 0;
+  parsePid(PID_COOLANT_TEMP, &temp);
+  return temp / PID_FIXED_ONE;
+}
+
+static void appendHexByte(char* dst, uint8_t value) {
+  dst[0] = value >> 4;
+  dst[1] = value & 0x0F;
+  for(uint8_t i = 0; i < 2; i++) dst[i] += dst[i] < 10 ? '0' : 'A' - 10;
+}
+
+bool ObdReader::subscribe(uint8_t pid) {
+  if(findSubscription(pid) != NULL) return true;
+  if(subscriptionCount == OBD_MAX_SUBSCRIPTIONS || pidDataLength(pid) == 0) return false;
+  if(!isPidSupported(pid)) return false;
+  obd_pid_value_t* slot = &subscriptions[subscriptionCount++];
+  slot->pid = pid;
+  slot->fresh = false;
+  slot->value = 0;
+  slot->stamp = 0;
+  return true;
+}
+
+obd_pid_value_t* ObdReader::findSubscription(uint8_t pid) {
+  for(uint8_t i = 0; i < subscriptionCount; i++) {
+    if(subscriptions[i].pid == pid) return &subscriptions[i];
+  }
+  return NULL;
+}
+
+bool ObdReader::submitPids(const uint8_t* pids, uint8_t count, obd_cmd_callback_t callback, void* ctx) {
+  uint8_t sent = 0;
+
+  if(busy() || count > OBD_MAX_PIDS_PER_REQUEST) return false;
+  char* cmd = cmdBuf;
+  *cmd++ = '0';
+  *cmd++ = '1';
+  for(uint8_t i = 0; i < count; i++) {
+    // the ECU would only answer NO DATA after a full timeout
+    if(!isPidSupported(pids[i])) continue;
+    appendHexByte(cmd, pids[i]);
+    cmd += 2;
+    sent++;
+  }
+  if(sent == 0) return false;
+  // a single PID can tell the adapter to stop after the first answer,
+  // a batch may span several CAN frames so let it wait
+  if(sent == 1) *cmd++ = '1';
+  *cmd = '\0';
+  if(!submit(cmdBuf, callback, ctx)) return false;
+  batchPending = true;
+  batchCount = sent;
+  return true;
+}
+
+bool ObdReader::submitSubscribed(obd_cmd_callback_t callback, void* ctx) {
+  uint8_t pids[OBD_MAX_PIDS_PER_REQUEST];
+  uint8_t count = 0;
+
+  // round robin so every subscription gets its turn when they don't fit
+  for(uint8_t i = 0; i < subscriptionCount && count < batchLimit; i++) {
+    uint8_t pid = subscriptions[subscriptionCursor].pid;
+    subscriptionCursor = (subscriptionCursor + 1) % subscriptionCount;
+    if(isPidSupported(pid)) pids[count++] = pid;
+  }
+  return submitPids(pids, count, callback, ctx);
+}
+
+uint8_t ObdReader::batchSize() {
+  return batchLimit;
+}
+
+bool ObdReader::queryPids(const uint8_t* pids, uint8_t count) {
+  if(!submitPids(pids, count)) return false;
+  while(busy()) poll();
+  return cmdState == OBD_CMD_DONE;
+}
+
+bool ObdReader::readPid(uint8_t pid, int32_t* value, unsigned long* stamp) {
+  obd_pid_value_t* slot = findSubscription(pid);
+  if(slot == NULL || slot->stamp == 0) return false;
+  *value = slot->value;
+  if(stamp != NULL) *stamp = slot->stamp;
+  slot->fresh = false;
+  return true;
+}
+
+bool ObdReader::storePid(uint8_t pid, const uint8_t* data) {
+  pid_desc_t desc;
+  obd_pid_value_t* slot = findSubscription(pid);
+  if(slot == NULL || !pidLookup(pid, &desc)) return false;
+  slot->value = pidScale(desc.scale, data);
+  slot->stamp = millis();
+  slot->fresh = true;
+  return true;
+}
+
+// Walk the answer of a mode 01 request. Single frame answers are one line
+// ("410C1AF8050D"), multi frame ISO-TP answers start with a byte count line
+// followed by indexed frames ("00E", "0:410C1AF8057B", "1:0D001132...").
+// Returns the number of PID values decoded.
+uint8_t ObdReader::decodePids() {
+  uint8_t decoded = 0;
+  // scaling only ever looks at A and B
+  uint8_t data[2];
+  uint8_t pid = 0;
+  uint8_t expected = 0;
+  uint8_t received = 0;
+  bool expectSid = true;
+  bool expectPid = false;
+  // multi frame answers are padded, only trust the announced byte count
+  uint16_t remaining = 0xFFFF;
+  uint8_t i = 0;
+
+  while(i < resLength) {
+    // find the end of the current line
+    uint8_t lineEnd = i;
+    while(lineEnd < resLength && resBuf[lineEnd] != '\r') lineEnd++;
+    uint8_t lineLength = lineEnd - i;
+
+    if(lineLength > 2 && resBuf[i + 1] == ':') {
+      // a consecutive frame continues the current message
+      if(resBuf[i] == '0') expectSid = true;
+      i += 2;
+    }
+    else if(lineLength == 3) {
+      // byte count of a multi frame answer
+      remaining = ((hexNibble(resBuf[i]) & 0x0F) << 8) | (hexByte(resBuf + i + 1) & 0xFF);
+    }
+    else {
+      // a line without frame index is a new single frame message
+      expectSid = true;
+    }
+
+    while(i + 1 < lineEnd && remaining > 0) {
+      int16_t value = hexByte(resBuf + i);
+      i += 2;
+      if(value < 0) break;
+      remaining--;
+
+      if(expectSid) {
+        if(value != 0x41) break;
+        expectSid = false;
+        expectPid = true;
+      }
+      else if(expectPid) {
+        pid = value;
+        expected = pidDataLength(pid);
+        received = 0;
+        // unknown length, the rest of the message can't be split
+        if(expected == 0) {
+          expectSid = true;
+          break;
+        }
+        expectPid = false;
+      }
+      else {
+        if(received < sizeof(data)) data[received] = value;
+        if(++received == expected) {
+          if(storePid(pid, data)) decoded++;
+          expectPid = true;
+        }
+      }
+    }
+    i = lineEnd + 1;
+  }
+  return decoded;
 }
@@ -2,12 +2,34 @@
 #define OBD_READER_H
 
 #define BAUDRATE 38400
+// try to move the link to a faster rate with ATBRD during setup
+#ifndef OBD_BAUD_NEGOTIATION
+#define OBD_BAUD_NEGOTIATION 1
+#endif
+// ATBRD handshake steps timeout (ms)
+#define OBD_BAUD_SWITCH_TIMEOUT 200
 #define OBD_CMD_RETRIES 5
 #define MAX_RESP_BUFFER 50
+// time allowed for the adapter to start answering a command
+#define OBD_FIRST_BYTE_TIMEOUT 4000
+// time allowed for the whole answer, prompt included
+#define OBD_PROMPT_TIMEOUT 5000
+// pause before sending a command again after a timeout
+#define OBD_RETRY_DELAY 1000
+// the ELM327 accepts up to six PIDs in a single mode 01 request on CAN
+#define OBD_MAX_PIDS_PER_REQUEST 6
+#define OBD_MAX_SUBSCRIPTIONS 8
+// round-trips kept to compute the median one
+#define OBD_RTT_SAMPLES 8
+// lowest ATST value (x4 ms) the low latency profile may set
+#define OBD_MIN_ADAPTER_TIMEOUT 0x10
+// supported PID bitmap for PIDs 01-80, filled from 0100/0120/0140/0160
+#define OBD_SUPPORTED_PID_BYTES 16
 
 #include <inttypes.h>
-#include <SoftwareSerial.h>
+#include <obdTransport.h>
 #include <obdReaderConfig.h>
+#include <PID.h>
 
 typedef enum {
   NO_ERROR = 0,
@@ -22,24 +44,138 @@ typedef enum {
   UNKOWN_ERROR
 } error_code_t;
 
+typedef enum {
+  OBD_CMD_IDLE = 0,
+  OBD_CMD_WAITING,    // command sent, nothing received yet
+  OBD_CMD_RECEIVING,  // answer is coming, waiting for the prompt
+  OBD_CMD_BACKOFF,    // timed out, waiting before the next attempt
+  OBD_CMD_DONE,
+  OBD_CMD_FAILED
+} obd_cmd_state_t;
+
+// called once when a submitted command is done or has failed
+typedef void (*obd_cmd_callback_t)(obd_cmd_state_t state, void* ctx);
+
+// last decoded value of a subscribed mode 01 PID
+typedef struct {
+  uint8_t pid;
+  bool fresh;
+  int32_t value;
+  unsigned long stamp;
+} obd_pid_value_t;
+
 class ObdReader{
   public:
-    ObdReader(obd_reader_conf_t config): config(config), debug_mode(false) {};
+    ObdReader(obd_reader_conf_t config): config(config), debug_mode(false), logOutput(NULL), cmdState(OBD_CMD_IDLE),
+      batchPending(false), batchLimit(OBD_MAX_PIDS_PER_REQUEST), subscriptionCount(0), subscriptionCursor(0),
+      supportedPidsKnown(false), currentProtocol(0), roundTripCount(0), roundTripIndex(0), formattingBytes(0),
+      lowLatency(false) {};
     char* resBuf;
     uint8_t resLength;
     error_code_t setup();
+    // blocking helpers, built on top of submit()/poll()
     int getRpm();
     int getEngineCoolantTemp();
+    // asynchronous API: submit a command then call poll() from loop()
+    // until the callback fires or busy() turns false
+    bool submit(const char* obd_cmd, obd_cmd_callback_t callback = NULL, void* ctx = NULL);
+    bool submit(const __FlashStringHelper* obd_cmd, obd_cmd_callback_t callback = NULL, void* ctx = NULL);
+    obd_cmd_state_t poll();
+    bool busy();
+    obd_cmd_state_t state();
+    bool requestPid(uint8_t pid, obd_cmd_callback_t callback, void* ctx = NULL);
+    bool requestRpm(obd_cmd_callback_t callback, void* ctx = NULL);
+    bool requestEngineCoolantTemp(obd_cmd_callback_t callback, void* ctx = NULL);
+    // blocking single PID query, value is PID_FIXED_ONE based
+    bool getPid(uint8_t pid, int32_t* value);
+    // decode the last response held in resBuf
+    bool parsePid(uint8_t pid, int32_t* value);
+    int parseRpm();
+    int parseEngineCoolantTemp();
+    // batched mode 01 requests: subscribed PIDs are packed together into
+    // as few requests as possible and every answer updates their values
+    bool subscribe(uint8_t pid);
+    bool submitPids(const uint8_t* pids, uint8_t count, obd_cmd_callback_t callback = NULL, void* ctx = NULL);
+    bool submitSubscribed(obd_cmd_callback_t callback = NULL, void* ctx = NULL);
+    bool queryPids(const uint8_t* pids, uint8_t count);
+    // how many PIDs a single request can carry with the current protocol
+    uint8_t batchSize();
+    // returns false if the PID is not subscribed or has no value yet,
+    // values are PID_FIXED_ONE based and reading one clears its fresh flag
+    bool readPid(uint8_t pid, int32_t* value, unsigned long* stamp = NULL);
+    bool hasFreshPid(uint8_t pid);
+    uint8_t decodePids();
+    // true if the ECU listed the PID in its supported PID answers, or if
+    // those have not been read yet. Unsupported PIDs are never requested.
+    bool isPidSupported(uint8_t pid);
     void enable_debug(bool enabled);
+    // where debug and error messages go, nothing is printed when NULL
+    void setLogOutput(Print* output);
+    // rate the link with the adapter runs at
+    unsigned long baudRate();
+    // median time (ms) between sending a PID request and its prompt over
+    // the last OBD_RTT_SAMPLES requests, 0 before the first one
+    uint16_t medianRoundTrip();
+    // protocol number reported by ATDPN ('1'..'C'), 0 if not connected
+    char protocol();
+    // true once every setting of the low latency profile was acknowledged
+    // and checked
+    bool lowLatencyActive();
   private:
     obd_reader_conf_t config;
     bool debug_mode;
-    void debug(const char* message, bool new_line);
-    void debug(const __FlashStringHelper* message, bool new_line);
+    Print* logOutput;
+    void log(const __FlashStringHelper* message, bool new_line = true);
+    void debug(const char* message, bool new_line = true);
+    void debug(const __FlashStringHelper* message, bool new_line = true);
     void printHex(const char* str, uint8_t size);
-    SoftwareSerial *serial;
-    char* send_OBD_cmd(const char* obd_cmd, bool waitPrompt);
+    ObdTransport *serial;
+    // in flight command
+    const char* pendingCmd;
+    bool pendingCmdInFlash;
+    obd_cmd_callback_t pendingCallback;
+    void* pendingCtx;
+    obd_cmd_state_t cmdState;
+    unsigned long cmdStamp;
+    uint8_t cmdRetries;
+    bool submitCmd(const char* obd_cmd, bool inFlash, obd_cmd_callback_t callback, void* ctx);
+    void sendPending();
+    void retryPending();
+    obd_cmd_state_t complete(obd_cmd_state_t state);
+    // batch state
+    char cmdBuf[2 + 2 * OBD_MAX_PIDS_PER_REQUEST + 2];
+    bool batchPending;
+    uint8_t batchCount;
+    uint8_t batchLimit;
+    obd_pid_value_t subscriptions[OBD_MAX_SUBSCRIPTIONS];
+    uint8_t subscriptionCount;
+    uint8_t subscriptionCursor;
+    obd_pid_value_t* findSubscription(uint8_t pid);
+    uint8_t supportedPids[OBD_SUPPORTED_PID_BYTES];
+    bool supportedPidsKnown;
+    bool decodeSupportedPids(uint8_t base);
+    bool storePid(uint8_t pid, const uint8_t* data);
+    char* send_OBD_cmd(const __FlashStringHelper* obd_cmd);
+    char* send_OBD_cmd(const char* obd_cmd);
     error_code_t obd_init();
+    unsigned long linkBaud;
+    char currentProtocol;
+    error_code_t connectEcu();
+    void storeProtocol();
+    uint16_t roundTrips[OBD_RTT_SAMPLES];
+    uint8_t roundTripCount;
+    uint8_t roundTripIndex;
+    // spaces and linefeeds received since the last reset, they should
+    // disappear with the low latency profile
+    uint16_t formattingBytes;
+    bool lowLatency;
+    void recordRoundTrip(uint16_t time);
+    bool applyLowLatencyProfile();
+    bool sendSetting(const __FlashStringHelper* setting);
+    bool acknowledged();
+    void negotiateBaudRate();
+    bool switchBaudRate(unsigned long baud);
+    bool waitForChar(char expected, uint16_t timeout);
     void replaceStrChar(char currentChr, char newChr);
 };
 #endif
@@ -0,0 +1,201 @@
+/*
+Link level settings of the adapter, negotiated once during setup.
+*/
+#include <Arduino.h>
+#include <EEPROM.h>
+#include "elm327.h"
+#include "obdStorage.h"
+
+// fastest first, all of them are close to a 4 MHz / n ELM327 rate and to a
+// 16 MHz / 8n AVR rate
+const unsigned long OBD_BAUD_RATES[] PROGMEM = { 500000, 115200, 57600 };
+const uint8_t OBD_BAUD_RATE_COUNT = sizeof(OBD_BAUD_RATES) / sizeof(OBD_BAUD_RATES[0]);
+
+unsigned long ObdReader::baudRate() {
+  return linkBaud;
+}
+
+// Step the link up with ATBRD. A rate that worked before is tried first,
+// then every supported one from the fastest down. The rate is not kept by
+// the adapter across power cycles, only the choice is stored.
+void ObdReader::negotiateBaudRate() {
+  uint8_t stored = EEPROM.read(OBD_EEPROM_BAUD_ADDR);
+
+  // leave enough time for us to answer the adapter at the new rate (x5 ms)
+  send_OBD_cmd(F("ATBRT19"));
+
+  if(stored < OBD_BAUD_RATE_COUNT) {
+    if(switchBaudRate(pgm_read_dword(OBD_BAUD_RATES + stored))) return;
+    EEPROM.update(OBD_EEPROM_BAUD_ADDR, OBD_EEPROM_UNKNOWN);
+  }
+  for(uint8_t i = 0; i < OBD_BAUD_RATE_COUNT; i++) {
+    unsigned long baud = pgm_read_dword(OBD_BAUD_RATES + i);
+    if(i == stored || baud > serial->maxBaud() || baud <= linkBaud) continue;
+    if(switchBaudRate(baud)) {
+      EEPROM.update(OBD_EEPROM_BAUD_ADDR, i);
+      return;
+    }
+  }
+  debug(F("Keeping default baud rate"));
+}
+
+// ATBRD handshake: the adapter answers OK, switches and prints its id at
+// the new rate, then waits for a '\r' from us. Without it, it goes back to
+// the old rate on its own.
+bool ObdReader::switchBaudRate(unsigned long baud) {
+  unsigned long previous = linkBaud;
+  uint8_t divisor = 4000000UL / baud;
+
+  if(baud > serial->maxBaud()) return false;
+  debug(F("Trying baud rate "), false);
+  if(debug_mode && logOutput != NULL) logOutput->println(baud);
+
+  while(serial->available() > 0) serial->read();
+  serial->print(F("ATBRD"));
+  serial->print(divisor < 0x10 ? "0" : "");
+  serial->print(divisor, HEX);
+  serial->print('\r');
+  // an adapter without ATBRD answers '?' and never says OK
+  if(!waitForChar('K', OBD_BAUD_SWITCH_TIMEOUT)) {
+    waitForChar('>', OBD_BAUD_SWITCH_TIMEOUT);
+    return false;
+  }
+  // the '\r' after OK is still sent at the old rate
+  waitForChar('\r', OBD_BAUD_SWITCH_TIMEOUT);
+
+  serial->begin(baud);
+  if(waitForChar('\r', OBD_BAUD_SWITCH_TIMEOUT)) {
+    serial->print('\r');
+    if(waitForChar('>', OBD_BAUD_SWITCH_TIMEOUT)) {
+      linkBaud = baud;
+      return true;
+    }
+  }
+
+  // the adapter fell back after its ATBRT timeout, follow it
+  serial->begin(previous);
+  waitForChar('>', OBD_BAUD_SWITCH_TIMEOUT);
+  return false;
+}
+
+bool ObdReader::waitForChar(char expected, uint16_t timeout) {
+  unsigned long start = millis();
+  while(millis() - start < timeout) {
+    if(serial->available() > 0 && serial->read() == expected) return true;
+  }
+  return false;
+}
+
+static bool isProtocolDigit(uint8_t protocol) {
+  return (protocol >= '1' && protocol <= '9') || (protocol >= 'A' && protocol <= 'C');
+}
+
+// The protocol that answered on the previous boot is selected directly, the
+// auto search (several seconds with ATSP0) only runs when it stays silent.
+// Reading the first supported PID range is the connection test.
+error_code_t ObdReader::connectEcu() {
+  uint8_t protocol = EEPROM.read(OBD_EEPROM_PROTOCOL_ADDR);
+
+  if(isProtocolDigit(protocol)) {
+    sprintf_P(cmdBuf, PSTR("ATSP%c"), protocol);
+    if(send_OBD_cmd(cmdBuf) == NULL) return SELECT_PROTOCOL_ERROR;
+    if(send_OBD_cmd(F("0100")) == NULL) return PID00_ERROR;   //send 0100, retrieve available pid's 01-20
+    if(decodeSupportedPids(0x00)) {
+      currentProtocol = protocol;
+      supportedPidsKnown = true;
+      if(protocol < '6') batchLimit = 1;
+      return NO_ERROR;
+    }
+    debug(F("Cached protocol failed, searching"));
+  }
+
+  //send ATSP0, protocol auto
+  if(send_OBD_cmd(F("ATSP0")) == NULL) return SELECT_PROTOCOL_ERROR;
+  if(send_OBD_cmd(F("0100")) == NULL) return PID00_ERROR;     //send 0100, retrieve available pid's 01-20
+  // ECU off: keep going, every PID stays assumed supported
+  if(!decodeSupportedPids(0x00)) return NO_ERROR;
+  supportedPidsKnown = true;
+  storeProtocol();
+  return NO_ERROR;
+}
+
+// ATDPN answers "A6" after an auto search, the digit is what ATSP takes
+void ObdReader::storeProtocol() {
+  if(send_OBD_cmd(F("ATDPN")) == NULL || resLength == 0) return;
+  char protocol = resBuf[resLength - 1] == '\r' ? resBuf[resLength - 2] : resBuf[resLength - 1];
+  if(!isProtocolDigit(protocol)) return;
+  currentProtocol = protocol;
+  EEPROM.update(OBD_EEPROM_PROTOCOL_ADDR, protocol);
+  // only CAN (6 to C) takes several PIDs per request
+  if(protocol < '6') batchLimit = 1;
+}
+
+char ObdReader::protocol() {
+  return currentProtocol;
+}
+
+// Settings are sent one by one and must all be acknowledged. Probing the
+// ECU afterwards checks the formatting is really gone and measures the
+// response time the ATST timeout is derived from.
+bool ObdReader::applyLowLatencyProfile() {
+  bool applied = true;
+  uint8_t probe = PID_SUPPORTED_PIDS_01_20;
+
+  applied &= sendSetting(F("ATS0"));                    // no spaces
+  applied &= sendSetting(F("ATH0"));                    // no headers
+  applied &= sendSetting(F("ATL0"));                    // no linefeeds
+  applied &= sendSetting(F("ATAT2"));                   // aggressive adaptive timing
+
+  formattingBytes = 0;
+  roundTripCount = 0;
+  for(uint8_t i = 0; i < OBD_RTT_SAMPLES; i++) queryPids(&probe, 1);
+  if(formattingBytes != 0) {
+    log(F("Adapter still sends spaces or linefeeds"));
+    applied = false;
+  }
+  if(roundTripCount == 0) return false;
+
+  // ATST counts 4 ms steps, keep a 50% margin over the median
+  uint16_t timeout = (medianRoundTrip() * 3 / 2 + 3) / 4;
+  if(timeout < OBD_MIN_ADAPTER_TIMEOUT) timeout = OBD_MIN_ADAPTER_TIMEOUT;
+  if(timeout > 0xFF) timeout = 0xFF;
+  sprintf_P(cmdBuf, PSTR("ATST%02X"), (uint8_t) timeout);
+  applied &= send_OBD_cmd(cmdBuf) != NULL && acknowledged();
+
+  lowLatency = applied;
+  return applied;
+}
+
+bool ObdReader::sendSetting(const __FlashStringHelper* setting) {
+  if(send_OBD_cmd(setting) != NULL && acknowledged()) return true;
+  debug(F("Setting refused: "), false);
+  debug(setting);
+  return false;
+}
+
+bool ObdReader::acknowledged() {
+  return strstr_P(resBuf, PSTR("OK")) != NULL;
+}
+
+bool ObdReader::lowLatencyActive() {
+  return lowLatency;
+}
+
+void ObdReader::recordRoundTrip(uint16_t time) {
+  roundTrips[roundTripIndex] = time;
+  roundTripIndex = (roundTripIndex + 1) % OBD_RTT_SAMPLES;
+  if(roundTripCount < OBD_RTT_SAMPLES) roundTripCount++;
+}
+
+uint16_t ObdReader::medianRoundTrip() {
+  uint16_t sorted[OBD_RTT_SAMPLES];
+
+  if(roundTripCount == 0) return 0;
+  // insertion sort, there are only a handful of samples
+  for(uint8_t i = 0; i < roundTripCount; i++) {
+    uint8_t k = i;
+    for(; k > 0 && sorted[k - 1] > roundTrips[i]; k--) sorted[k] = sorted[k - 1];
+    sorted[k] = roundTrips[i];
+  }
+  return sorted[roundTripCount / 2];
+}
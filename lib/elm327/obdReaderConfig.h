@@ -3,9 +3,21 @@
 
 #include <inttypes.h>
 
+class ObdTransport;
+
+typedef enum {
+  OBD_PROFILE_DEFAULT = 0,
+  // spaces, headers and linefeeds off, aggressive adaptive timing and an
+  // ATST tuned to the measured ECU response time
+  OBD_PROFILE_LOW_LATENCY
+} obd_profile_t;
+
 typedef struct {
   unsigned int rxPin;
   unsigned int txPin;
+  // link to the adapter, a SoftwareSerial on rxPin/txPin when NULL
+  ObdTransport* transport;
+  obd_profile_t profile;
 } obd_reader_conf_t;
 
 #endif
\ No newline at end of file
@@ -0,0 +1,11 @@
+#ifndef _OBD_STORAGE_H
+#define _OBD_STORAGE_H
+
+// EEPROM bytes owned by ObdReader, an erased byte (0xFF) means unknown
+#define OBD_EEPROM_BAUD_ADDR 0      // index in OBD_BAUD_RATES
+#define OBD_EEPROM_PROTOCOL_ADDR 1  // ATDPN digit of the last working protocol
+#define OBD_EEPROM_BASE_END 8       // first byte free for other users
+
+#define OBD_EEPROM_UNKNOWN 0xFF
+
+#endif
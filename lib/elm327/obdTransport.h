@@ -0,0 +1,15 @@
+#ifndef _OBD_TRANSPORT_H
+#define _OBD_TRANSPORT_H
+
+#include <Arduino.h>
+
+// Byte link between ObdReader and the ELM327. Stream gives the reader
+// print() for free, backends only provide the raw byte access.
+class ObdTransport: public Stream {
+  public:
+    virtual void begin(unsigned long baud) = 0;
+    // fastest rate the backend receives reliably
+    virtual unsigned long maxBaud() = 0;
+};
+
+#endif
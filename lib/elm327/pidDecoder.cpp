@@ -0,0 +1,96 @@
+#include <Arduino.h>
+#include "pidDecoder.h"
+
+#define PID_DESC_ENTRY(name, pid, bytes, scale) { pid, bytes, scale },
+const pid_desc_t PID_TABLE[] PROGMEM = {
+  OBD_PID_LIST(PID_DESC_ENTRY)
+};
+#undef PID_DESC_ENTRY
+const uint8_t PID_TABLE_SIZE = sizeof(PID_TABLE) / sizeof(PID_TABLE[0]);
+
+// value = (raw + offset) * mul / div, raw is A or AB depending on the flags
+#define SCALE_WORD 0x01
+#define SCALE_SIGNED 0x02
+
+typedef struct {
+  int16_t offset;
+  uint16_t mul;
+  uint16_t div;
+  uint8_t flags;
+} pid_scaling_t;
+
+// indexed by pid_scale_t, mul already includes PID_FIXED_ONE
+const pid_scaling_t PID_SCALINGS[PID_SCALE_COUNT] PROGMEM = {
+  {      0,     1,     1, 0 },                          // PID_SCALE_RAW
+  {      0,   100,     1, 0 },                          // PID_SCALE_A
+  {    -40,   100,     1, 0 },                          // PID_SCALE_A_MINUS_40
+  {   -125,   100,     1, 0 },                          // PID_SCALE_A_MINUS_125
+  {      0, 10000,   255, 0 },                          // PID_SCALE_A_PERCENT
+  {   -128, 10000,   128, 0 },                          // PID_SCALE_A_TRIM
+  {   -128,    50,     1, 0 },                          // PID_SCALE_A_TIMING
+  {      0,   300,     1, 0 },                          // PID_SCALE_A_X3
+  {      0,  1000,     1, 0 },                          // PID_SCALE_A_X10
+  {      0,     1,     2, 0 },                          // PID_SCALE_A_DIV_200
+  {      0,   100,     1, SCALE_WORD },                 // PID_SCALE_AB
+  {      0,    25,     1, SCALE_WORD },                 // PID_SCALE_AB_DIV_4
+  {      0,     1,     1, SCALE_WORD },                 // PID_SCALE_AB_DIV_100
+  {      0,     1,     2, SCALE_WORD },                 // PID_SCALE_AB_DIV_200
+  {      0,     1,    10, SCALE_WORD },                 // PID_SCALE_AB_DIV_1000
+  {      0,   100, 32768, SCALE_WORD },                 // PID_SCALE_AB_DIV_32768
+  {      0,    25,     1, SCALE_WORD | SCALE_SIGNED },  // PID_SCALE_AB_SIGNED_DIV_4
+  {      0, 10000,   255, SCALE_WORD },                 // PID_SCALE_AB_PERCENT
+  {      0,    79,    10, SCALE_WORD },                 // PID_SCALE_AB_X0079
+  {      0,     5,     1, SCALE_WORD },                 // PID_SCALE_AB_X005
+  {      0,  1000,     1, SCALE_WORD },                 // PID_SCALE_AB_X10
+  { -26880,   100,   128, SCALE_WORD },                 // PID_SCALE_AB_INJECTION
+};
+
+// '0'..'F' mapped to their value, 0xFF for the punctuation in between
+const uint8_t HEX_NIBBLES[] PROGMEM = {
+  0, 1, 2, 3, 4, 5, 6, 7, 8, 9,
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  10, 11, 12, 13, 14, 15
+};
+
+bool pidLookup(uint8_t pid, pid_desc_t* desc) {
+  for(uint8_t i = 0; i < PID_TABLE_SIZE; i++) {
+    if(pgm_read_byte(&PID_TABLE[i].pid) == pid) {
+      memcpy_P(desc, &PID_TABLE[i], sizeof(pid_desc_t));
+      return desc->bytes != 0;
+    }
+  }
+  return false;
+}
+
+uint8_t pidDataLength(uint8_t pid) {
+  pid_desc_t desc;
+  return pidLookup(pid, &desc) ? desc.bytes : 0;
+}
+
+int32_t pidScale(uint8_t scale, const uint8_t* data) {
+  pid_scaling_t scaling;
+  int32_t raw;
+
+  if(scale >= PID_SCALE_COUNT) scale = PID_SCALE_RAW;
+  memcpy_P(&scaling, &PID_SCALINGS[scale], sizeof(pid_scaling_t));
+  if(scaling.flags & SCALE_WORD) {
+    raw = ((uint16_t)data[0] << 8) | data[1];
+    if(scaling.flags & SCALE_SIGNED) raw = (int16_t)raw;
+  }
+  else {
+    raw = data[0];
+  }
+  return (raw + scaling.offset) * scaling.mul / scaling.div;
+}
+
+uint8_t hexNibble(char c) {
+  uint8_t index = c - '0';
+  return index < sizeof(HEX_NIBBLES) ? pgm_read_byte(HEX_NIBBLES + index) : 0xFF;
+}
+
+int16_t hexByte(const char* str) {
+  uint8_t high = hexNibble(str[0]);
+  uint8_t low = hexNibble(str[1]);
+  if((high | low) & 0xF0) return -1;
+  return (high << 4) | low;
+}
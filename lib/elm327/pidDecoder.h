@@ -0,0 +1,24 @@
+#ifndef _PID_DECODER_H
+#define _PID_DECODER_H
+
+#include <inttypes.h>
+#include <PID.h>
+
+typedef struct {
+  uint8_t pid;
+  uint8_t bytes;
+  uint8_t scale;
+} pid_desc_t;
+
+// copy the descriptor of a mode 01 PID out of flash, false if unknown
+bool pidLookup(uint8_t pid, pid_desc_t* desc);
+// number of data bytes following the PID in an answer, 0 if unknown
+uint8_t pidDataLength(uint8_t pid);
+// scale the first data bytes of an answer to a PID_FIXED_ONE based value
+int32_t pidScale(uint8_t scale, const uint8_t* data);
+// value of a hex digit, 0xFF if c is not one
+uint8_t hexNibble(char c);
+// value of the two hex digits at str, -1 if they are not
+int16_t hexByte(const char* str);
+
+#endif
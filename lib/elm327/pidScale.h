@@ -0,0 +1,35 @@
+#ifndef _PID_SCALE_H
+#define _PID_SCALE_H
+
+// Decoded values are fixed point, PID_FIXED_ONE is 1.0 in the unit of the
+// PID (rpm, degree C, %, kPa...). PID_SCALE_RAW values are not scaled.
+#define PID_FIXED_ONE 100
+
+// A is the first data byte of the answer, AB the first two as a word
+typedef enum {
+  PID_SCALE_RAW = 0,
+  PID_SCALE_A,
+  PID_SCALE_A_MINUS_40,
+  PID_SCALE_A_MINUS_125,
+  PID_SCALE_A_PERCENT,
+  PID_SCALE_A_TRIM,
+  PID_SCALE_A_TIMING,
+  PID_SCALE_A_X3,
+  PID_SCALE_A_X10,
+  PID_SCALE_A_DIV_200,
+  PID_SCALE_AB,
+  PID_SCALE_AB_DIV_4,
+  PID_SCALE_AB_DIV_100,
+  PID_SCALE_AB_DIV_200,
+  PID_SCALE_AB_DIV_1000,
+  PID_SCALE_AB_DIV_32768,
+  PID_SCALE_AB_SIGNED_DIV_4,
+  PID_SCALE_AB_PERCENT,
+  PID_SCALE_AB_X0079,
+  PID_SCALE_AB_X005,
+  PID_SCALE_AB_X10,
+  PID_SCALE_AB_INJECTION,
+  PID_SCALE_COUNT
+} pid_scale_t;
+
+#endif
@@ -0,0 +1,101 @@
+#include <Arduino.h>
+#include "pidScheduler.h"
+
+bool PidScheduler::add(uint8_t pid, uint16_t period, uint8_t priority) {
+  if(entryCount == SCHEDULER_MAX_ENTRIES || !reader.subscribe(pid)) return false;
+  pid_schedule_t* entry = &entries[entryCount++];
+  entry->pid = pid;
+  entry->priority = priority;
+  entry->period = period;
+  entry->due = millis();
+  entry->missed = 0;
+  return true;
+}
+
+void PidScheduler::onDeadlineMiss(deadline_miss_callback_t callback) {
+  missCallback = callback;
+}
+
+uint16_t PidScheduler::missedDeadlines(uint8_t pid) {
+  for(uint8_t i = 0; i < entryCount; i++) {
+    if(entries[i].pid == pid) return entries[i].missed;
+  }
+  return 0;
+}
+
+uint16_t PidScheduler::missedDeadlines() {
+  uint16_t total = 0;
+  for(uint8_t i = 0; i < entryCount; i++) total += entries[i].missed;
+  return total;
+}
+
+// Lower is more urgent. Every full period an entry is late raises it by
+// one priority level so slow signals are never starved by fast ones.
+uint8_t PidScheduler::urgency(const pid_schedule_t* entry, unsigned long now) {
+  unsigned long late = (now - entry->due) / entry->period;
+  return late >= entry->priority ? 0 : entry->priority - late;
+}
+
+void PidScheduler::markServed(pid_schedule_t* entry, unsigned long now) {
+  unsigned long lateness = now - entry->due;
+  if(lateness >= entry->period) {
+    // drop the slots we could not serve and restart from now
+    entry->missed++;
+    entry->due = now + entry->period;
+    if(missCallback != NULL) missCallback(entry->pid, lateness);
+  }
+  else {
+    // keep the phase so the average rate matches the period
+    entry->due += entry->period;
+  }
+}
+
+void PidScheduler::run() {
+  uint8_t pids[OBD_MAX_PIDS_PER_REQUEST];
+  pid_schedule_t* picked[OBD_MAX_PIDS_PER_REQUEST];
+  uint8_t count = 0;
+  uint8_t limit = reader.batchSize();
+  unsigned long now = millis();
+
+  reader.poll();
+  if(reader.busy()) return;
+
+  // entries due before the answer would come back ride along, a batch
+  // costs about the same round-trip as a single PID
+  unsigned long horizon = now + lastRoundTrip;
+
+  while(count < limit) {
+    pid_schedule_t* best = NULL;
+    uint8_t bestUrgency = 0xFF;
+    for(uint8_t i = 0; i < entryCount; i++) {
+      pid_schedule_t* entry = &entries[i];
+      bool taken = false;
+      for(uint8_t k = 0; k < count; k++) taken |= picked[k] == entry;
+      if(taken || (long)(horizon - entry->due) < 0 || !reader.isPidSupported(entry->pid)) continue;
+      uint8_t level = (long)(now - entry->due) < 0 ? entry->priority : urgency(entry, now);
+      // same urgency: the one that waited the longest goes first
+      if(best == NULL || level < bestUrgency || (level == bestUrgency && (long)(entry->due - best->due) < 0)) {
+        best = entry;
+        bestUrgency = level;
+      }
+    }
+    if(best == NULL) break;
+    picked[count] = best;
+    pids[count++] = best->pid;
+  }
+  if(count == 0) return;
+
+  if(reader.submitPids(pids, count, onResponse, this)) {
+    requestStamp = now;
+    for(uint8_t k = 0; k < count; k++) {
+      // early riders keep their phase, they were not late
+      if((long)(now - picked[k]->due) < 0) picked[k]->due += picked[k]->period;
+      else markServed(picked[k], now);
+    }
+  }
+}
+
+void PidScheduler::onResponse(obd_cmd_state_t state, void* ctx) {
+  PidScheduler* scheduler = (PidScheduler*) ctx;
+  if(state == OBD_CMD_DONE) scheduler->lastRoundTrip = millis() - scheduler->requestStamp;
+}
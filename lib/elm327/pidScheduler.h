@@ -0,0 +1,43 @@
+#ifndef _PID_SCHEDULER_H
+#define _PID_SCHEDULER_H
+
+#include <inttypes.h>
+#include <elm327.h>
+
+#define SCHEDULER_MAX_ENTRIES OBD_MAX_SUBSCRIPTIONS
+
+typedef struct {
+  uint8_t pid;
+  uint8_t priority;       // 0 is the most important
+  uint16_t period;        // target refresh period in ms
+  unsigned long due;      // next time a sample is wanted
+  uint16_t missed;        // number of periods skipped
+} pid_schedule_t;
+
+// called when a PID is served a whole period or more after it was due
+typedef void (*deadline_miss_callback_t)(uint8_t pid, unsigned long lateness);
+
+class PidScheduler {
+  public:
+    PidScheduler(ObdReader& reader): reader(reader), entryCount(0), missCallback(NULL), lastRoundTrip(0) {};
+    // subscribe the PID on the reader and poll it every period ms
+    bool add(uint8_t pid, uint16_t period, uint8_t priority);
+    void onDeadlineMiss(deadline_miss_callback_t callback);
+    // call from loop(), never blocks: polls the reader and packs the most
+    // urgent due PIDs into the next request as soon as it is idle
+    void run();
+    uint16_t missedDeadlines(uint8_t pid);
+    uint16_t missedDeadlines();
+  private:
+    ObdReader& reader;
+    pid_schedule_t entries[SCHEDULER_MAX_ENTRIES];
+    uint8_t entryCount;
+    deadline_miss_callback_t missCallback;
+    unsigned long requestStamp;
+    unsigned long lastRoundTrip;
+    uint8_t urgency(const pid_schedule_t* entry, unsigned long now);
+    void markServed(pid_schedule_t* entry, unsigned long now);
+    static void onResponse(obd_cmd_state_t state, void* ctx);
+};
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef _RING_BUFFER_H
+#define _RING_BUFFER_H
+
+#include <inttypes.h>
+
+// Lock-free single producer / single consumer byte queue. The producer is
+// meant to be an ISR and the consumer the main loop: each side only writes
+// its own index and 8 bit accesses are atomic on AVR. SIZE must be a power
+// of two, one slot is kept empty to tell full from empty.
+template<uint8_t SIZE>
+class RingBuffer {
+  public:
+    RingBuffer(): head(0), tail(0), dropped(0) {};
+    bool push(uint8_t value) {
+      uint8_t next = (head + 1) & (SIZE - 1);
+      if(next == tail) {
+        dropped++;
+        return false;
+      }
+      data[head] = value;
+      head = next;
+      return true;
+    }
+    int pop() {
+      if(tail == head) return -1;
+      uint8_t value = data[tail];
+      tail = (tail + 1) & (SIZE - 1);
+      return value;
+    }
+    int peek() {
+      return tail == head ? -1 : data[tail];
+    }
+    uint8_t count() {
+      return (head - tail) & (SIZE - 1);
+    }
+    // bytes lost because the consumer was too slow
+    uint16_t overflows() {
+      return dropped;
+    }
+  private:
+    volatile uint8_t head;
+    volatile uint8_t tail;
+    volatile uint16_t dropped;
+    volatile uint8_t data[SIZE];
+};
+
+#endif
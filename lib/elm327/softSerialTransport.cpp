@@ -0,0 +1,24 @@
+#include <Arduino.h>
+#include "softSerialTransport.h"
+
+void SoftSerialTransport::begin(unsigned long baud) {
+  pinMode(rxPin, INPUT);
+  pinMode(txPin, OUTPUT);
+  serial.begin(baud);
+}
+
+int SoftSerialTransport::available() {
+  return serial.available();
+}
+
+int SoftSerialTransport::read() {
+  return serial.read();
+}
+
+int SoftSerialTransport::peek() {
+  return serial.peek();
+}
+
+size_t SoftSerialTransport::write(uint8_t value) {
+  return serial.write(value);
+}
@@ -0,0 +1,25 @@
+#ifndef _SOFT_SERIAL_TRANSPORT_H
+#define _SOFT_SERIAL_TRANSPORT_H
+
+#include <SoftwareSerial.h>
+#include <obdTransport.h>
+
+// bit-banged link on any two pins, leaves USART0 to Serial
+class SoftSerialTransport: public ObdTransport {
+  public:
+    SoftSerialTransport(uint8_t rxPin, uint8_t txPin): rxPin(rxPin), txPin(txPin), serial(rxPin, txPin) {};
+    void begin(unsigned long baud);
+    // bit-banged reception gets unreliable above this
+    unsigned long maxBaud() { return 57600UL; }
+    int available();
+    int read();
+    int peek();
+    size_t write(uint8_t value);
+    using Print::write;
+  private:
+    uint8_t rxPin;
+    uint8_t txPin;
+    SoftwareSerial serial;
+};
+
+#endif
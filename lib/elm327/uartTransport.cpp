@@ -0,0 +1,64 @@
+#include <Arduino.h>
+#include "uartTransport.h"
+
+#if defined(OBD_USE_HW_UART) && defined(UBRR0H)
+#include <avr/interrupt.h>
+#include <ringBuffer.h>
+
+static RingBuffer<OBD_UART_RX_BUFFER> rxRing;
+static volatile uint16_t rxErrors = 0;
+
+ISR(USART_RX_vect) {
+  uint8_t status = UCSR0A;
+  uint8_t value = UDR0;
+  if(status & (_BV(FE0) | _BV(DOR0))) rxErrors++;
+  rxRing.push(value);
+}
+
+void HardwareUartTransport::begin(unsigned long baud) {
+  // double speed mode gives the smallest error at 115200 and above
+  uint16_t setting = (F_CPU / 4 / baud - 1) / 2;
+  UCSR0B = 0;
+  UCSR0A = _BV(U2X0);
+  UBRR0H = setting >> 8;
+  UBRR0L = setting;
+  UCSR0C = _BV(UCSZ01) | _BV(UCSZ00);                   // 8N1
+  UCSR0B = _BV(RXEN0) | _BV(TXEN0) | _BV(RXCIE0);
+}
+
+int HardwareUartTransport::available() {
+  return rxRing.count();
+}
+
+int HardwareUartTransport::read() {
+  return rxRing.pop();
+}
+
+int HardwareUartTransport::peek() {
+  return rxRing.peek();
+}
+
+size_t HardwareUartTransport::write(uint8_t value) {
+  // commands are a few bytes long, no need for a TX ring
+  while(!(UCSR0A & _BV(UDRE0)));
+  UDR0 = value;
+  return 1;
+}
+
+uint16_t HardwareUartTransport::overflows() {
+  uint8_t sreg = SREG;
+  cli();
+  uint16_t count = rxRing.overflows();
+  SREG = sreg;
+  return count;
+}
+
+uint16_t HardwareUartTransport::errors() {
+  uint8_t sreg = SREG;
+  cli();
+  uint16_t count = rxErrors;
+  SREG = sreg;
+  return count;
+}
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef _UART_TRANSPORT_H
+#define _UART_TRANSPORT_H
+
+#include <obdTransport.h>
+
+// Only built with -DOBD_USE_HW_UART: the RX interrupt below replaces the
+// one of the Arduino core, so Serial must not be used in that build.
+#ifdef OBD_USE_HW_UART
+
+#ifndef OBD_UART_RX_BUFFER
+#define OBD_UART_RX_BUFFER 64
+#endif
+
+// USART0 driven link, received bytes are queued by the RX interrupt in a
+// lock-free ring and consumed by ObdReader::poll()
+class HardwareUartTransport: public ObdTransport {
+  public:
+    void begin(unsigned long baud);
+    // exact divisor at 16 MHz
+    unsigned long maxBaud() { return 500000UL; }
+    int available();
+    int read();
+    int peek();
+    size_t write(uint8_t value);
+    using Print::write;
+    // bytes dropped because the ring was full
+    uint16_t overflows();
+    // framing and data overrun errors reported by the USART
+    uint16_t errors();
+};
+
+#endif
+#endif
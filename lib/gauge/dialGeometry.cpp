@@ -0,0 +1,96 @@
+#include "dialGeometry.h"
+
+// sin(i * 90° / DIAL_QUARTER_STEPS) in Q30
+const int32_t QUARTER_SINE[DIAL_QUARTER_STEPS + 1] PROGMEM = {
+  0, 26350943, 52686014, 78989349, 105245103, 131437462,
+  157550647, 183568930, 209476638, 235258165, 260897982, 286380643,
+  311690799, 336813204, 361732726, 386434353, 410903207, 435124548,
+  459083786, 482766489, 506158392, 529245404, 552013618, 574449320,
+  596538995, 618269338, 639627258, 660599890, 681174602, 701339000,
+  721080937, 740388522, 759250125, 777654384, 795590213, 813046808,
+  830013654, 846480531, 862437520, 877875009, 892783698, 907154608,
+  920979082, 934248793, 946955747, 959092290, 970651112, 981625251,
+  992008094, 1001793390, 1010975242, 1019548121, 1027506862, 1034846671,
+  1041563127, 1047652185, 1053110176, 1057933813, 1062120190, 1065666786,
+  1068571464, 1070832474, 1072448455, 1073418433, 1073741824,
+};
+
+// one step in radians, Q30
+#define DIAL_STEP_Q30 26353589L
+
+// The float code rounded PI, the angle and its conversion to radians, so its
+// angles were off by about 1e-7 radian. That matters only where a coordinate
+// lands exactly on a pixel edge, at multiples of 30°. These are the offsets
+// the float code had there, in Q30 radians, from 180° to 360°.
+const int16_t EXACT_ANGLE_OFFSETS[7] PROGMEM = { 94, -18, 125, 13, -100, -212, 188 };
+
+static int32_t mulQ30(int32_t a, int32_t b) {
+  return ((int64_t)a * b) >> 30;
+}
+
+static int32_t stepSine(uint8_t step) {
+  return (int32_t)pgm_read_dword(QUARTER_SINE + (step <= DIAL_QUARTER_STEPS ? step : DIAL_HALF_STEPS - step));
+}
+
+static int32_t stepCosine(uint8_t step) {
+  if(step <= DIAL_QUARTER_STEPS) return (int32_t)pgm_read_dword(QUARTER_SINE + DIAL_QUARTER_STEPS - step);
+  return -(int32_t)pgm_read_dword(QUARTER_SINE + step - DIAL_QUARTER_STEPS);
+}
+
+dial_angle_t dialAngle(uint16_t rpm) {
+  if(rpm > GAUGE_MAX_RPM) rpm = GAUGE_MAX_RPM;
+  uint32_t scaled = (uint32_t)rpm * DIAL_HALF_STEPS;
+  dial_angle_t angle;
+  angle.step = scaled / GAUGE_MAX_RPM;
+  int32_t remainder = scaled % GAUGE_MAX_RPM;
+  // round to the closest step so that the series below stays short
+  if(2 * remainder >= GAUGE_MAX_RPM) {
+    angle.step++;
+    remainder -= GAUGE_MAX_RPM;
+  }
+  // remainder / GAUGE_MAX_RPM in Q24, in two divisions to stay on 32 bits
+  uint32_t magnitude = remainder < 0 ? -remainder : remainder;
+  uint32_t high = (magnitude << 16) / GAUGE_MAX_RPM;
+  uint32_t low = (((magnitude << 16) % GAUGE_MAX_RPM) << 8) / GAUGE_MAX_RPM;
+  int32_t delta = ((int64_t)((high << 8) | low) * DIAL_STEP_Q30) >> 24;
+  angle.delta = remainder < 0 ? -delta : delta;
+  uint32_t sixths = (uint32_t)rpm * 6;
+  if(sixths % GAUGE_MAX_RPM == 0) {
+    angle.delta += (int16_t)pgm_read_word(EXACT_ANGLE_OFFSETS + sixths / GAUGE_MAX_RPM);
+  }
+  return angle;
+}
+
+// rounds a Q30 value to the 24 significant bits of a float
+static int64_t floatRound(int64_t value) {
+  int64_t magnitude = value < 0 ? -value : value;
+  uint8_t bits = 0;
+  for(int64_t rest = magnitude; rest; rest >>= 1) bits++;
+  if(bits <= 24) return value;
+  int64_t ulp = 1LL << (bits - 24);
+  magnitude = (magnitude + ulp / 2) & ~(ulp - 1);
+  return value < 0 ? -magnitude : magnitude;
+}
+
+// center - radius * value, rounded at each step like the float code and
+// truncated to a pixel
+static int16_t dialCoordinate(int16_t center, uint8_t radius, int32_t value) {
+  int64_t offset = floatRound((int64_t)radius * floatRound(value));
+  return floatRound(((int64_t)center << 30) - offset) >> 30;
+}
+
+dial_point_t dialPoint(int16_t center_x, int16_t center_y, uint8_t radius, dial_angle_t angle) {
+  // Taylor series around the step, the 4th order term is below 1e-9
+  int32_t sine = stepSine(angle.step);
+  int32_t cosine = stepCosine(angle.step);
+  int32_t d = angle.delta;
+  int32_t d2 = mulQ30(d, d);
+  int32_t d3 = mulQ30(d2, d) / 6;
+  int32_t sin_phi = sine + mulQ30(d, cosine) - mulQ30(d2, sine) / 2 - mulQ30(d3, cosine);
+  int32_t cos_phi = cosine - mulQ30(d, sine) - mulQ30(d2, cosine) / 2 + mulQ30(d3, sine);
+  // the dial starts on the left, at 180°: cos(180° + phi) = -cos(phi)
+  dial_point_t point;
+  point.x = dialCoordinate(center_x, radius, cos_phi);
+  point.y = dialCoordinate(center_y, radius, sin_phi);
+  return point;
+}
@@ -0,0 +1,34 @@
+#ifndef _DIAL_GEOMETRY_H
+#define _DIAL_GEOMETRY_H
+
+#include <Arduino.h>
+#include "gaugeConfig.h"
+
+// Integer replacement of the float cos/sin code that placed the ticks, labels
+// and needle of the RPM dial. Points are the ones the float code computed on
+// the ATmega, pixel for pixel.
+
+// steps of the quarter-wave sine table, a half dial spans twice as many
+#define DIAL_QUARTER_STEPS 64
+#define DIAL_HALF_STEPS (2 * DIAL_QUARTER_STEPS)
+
+#if GAUGE_MAX_RPM <= 0 || GAUGE_MAX_RPM > 65535
+#error "GAUGE_MAX_RPM must fit in 16 bits"
+#endif
+
+typedef struct {
+  int16_t x;
+  int16_t y;
+} dial_point_t;
+
+// position of an rpm value on the dial, counted from the left end
+typedef struct {
+  uint8_t step;  // 180° / DIAL_HALF_STEPS units
+  int32_t delta; // remainder from the step in radians, Q30
+} dial_angle_t;
+
+// rpm above GAUGE_MAX_RPM are clamped to the right end
+dial_angle_t dialAngle(uint16_t rpm);
+dial_point_t dialPoint(int16_t center_x, int16_t center_y, uint8_t radius, dial_angle_t angle);
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef _GAUGE_CONFIG_H
+#define _GAUGE_CONFIG_H
+
+// RPM dial settings, override them from build_flags, e.g.
+// -DGAUGE_MAX_RPM=7000 '-DGAUGE_MAJOR_TICKS=0,1000,2000,3000,4000,5000,6000,7000'
+// The dial face bitmap has to be regenerated with the same values unless
+// DIAL_FACE_RUNTIME is defined (see tools/gen_dial_face.py).
+
+// rpm at the right end of the dial, the needle stops there
+#ifndef GAUGE_MAX_RPM
+#define GAUGE_MAX_RPM 5000
+#endif
+
+// comma separated rpm values, the last one is expected to be GAUGE_MAX_RPM
+#ifndef GAUGE_MAJOR_TICKS
+#define GAUGE_MAJOR_TICKS 0, 1000, 2000, 3000, 4000, 5000
+#endif
+
+#ifndef GAUGE_MINOR_TICKS
+#define GAUGE_MINOR_TICKS 500, 1500, 2500, 3500, 4500
+#endif
+
+// Needle animation: frames are drawn every GAUGE_FRAME_PERIOD ms and the
+// needle follows an alpha-beta estimate of the rpm between OBD samples.
+#ifndef GAUGE_FRAME_PERIOD
+#define GAUGE_FRAME_PERIOD 40
+#endif
+
+// share of the prediction error corrected on each sample, 256 = 1.0: higher
+// follows the samples closer, lower smooths noisy ones
+#ifndef GAUGE_ESTIMATOR_ALPHA
+#define GAUGE_ESTIMATOR_ALPHA 192
+#endif
+
+// share of the prediction error fed into the rpm rate, 256 = 1.0: higher
+// reacts faster to an acceleration but overshoots more
+#ifndef GAUGE_ESTIMATOR_BETA
+#define GAUGE_ESTIMATOR_BETA 48
+#endif
+
+// longest extrapolation past the last sample (ms), the needle waits there
+#ifndef GAUGE_PREDICTION_LIMIT
+#define GAUGE_PREDICTION_LIMIT 250
+#endif
+
+// a sample coming later than this (ms) restarts the estimate from it
+#ifndef GAUGE_ESTIMATOR_TIMEOUT
+#define GAUGE_ESTIMATOR_TIMEOUT 1000
+#endif
+
+#endif
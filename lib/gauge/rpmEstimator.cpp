@@ -0,0 +1,54 @@
+#include "rpmEstimator.h"
+
+#define ESTIMATOR_POSITION_SHIFT 8
+#define ESTIMATOR_RATE_SHIFT 12
+// 256 rpm per ms, far above any engine, keeps rate * dt on 32 bits
+#define ESTIMATOR_MAX_RATE (256L << ESTIMATOR_RATE_SHIFT)
+
+RpmEstimator::RpmEstimator() {
+  reset();
+}
+
+void RpmEstimator::reset() {
+  position = 0;
+  rate = 0;
+  lastStamp = 0;
+  started = false;
+}
+
+bool RpmEstimator::ready() {
+  return started;
+}
+
+void RpmEstimator::update(int32_t rpm, unsigned long stamp) {
+  unsigned long dt = stamp - lastStamp;
+  int32_t measured = rpm << ESTIMATOR_POSITION_SHIFT;
+  if(!started || dt > GAUGE_ESTIMATOR_TIMEOUT) {
+    position = measured;
+    rate = 0;
+    lastStamp = stamp;
+    started = true;
+    return;
+  }
+  // two answers in the same ms, keep the latest one
+  if(dt == 0) {
+    position = measured;
+    return;
+  }
+  int32_t predicted = position + ((rate * (int32_t)dt) >> (ESTIMATOR_RATE_SHIFT - ESTIMATOR_POSITION_SHIFT));
+  int32_t residual = measured - predicted;
+  position = predicted + (int32_t)(((int64_t)residual * GAUGE_ESTIMATOR_ALPHA) >> 8);
+  // residual * beta is Q16, the rate Q12
+  rate += (int32_t)((((int64_t)residual * GAUGE_ESTIMATOR_BETA) >> (16 - ESTIMATOR_RATE_SHIFT)) / (int32_t)dt);
+  rate = constrain(rate, -ESTIMATOR_MAX_RATE, ESTIMATOR_MAX_RATE);
+  lastStamp = stamp;
+}
+
+int32_t RpmEstimator::estimate(unsigned long now) {
+  if(!started) return 0;
+  unsigned long dt = now - lastStamp;
+  if(dt > GAUGE_PREDICTION_LIMIT) dt = GAUGE_PREDICTION_LIMIT;
+  int32_t value = position + ((rate * (int32_t)dt) >> (ESTIMATOR_RATE_SHIFT - ESTIMATOR_POSITION_SHIFT));
+  if(value < 0) return 0;
+  return (value + (1 << (ESTIMATOR_POSITION_SHIFT - 1))) >> ESTIMATOR_POSITION_SHIFT;
+}
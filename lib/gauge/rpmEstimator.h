@@ -0,0 +1,26 @@
+#ifndef _RPM_ESTIMATOR_H
+#define _RPM_ESTIMATOR_H
+
+#include <Arduino.h>
+#include "gaugeConfig.h"
+
+// Alpha-beta tracker of the engine speed. Each OBD sample corrects a
+// position and a rate, estimate() extrapolates them to the frame time so
+// the needle keeps moving between samples. Gains are in gaugeConfig.h.
+class RpmEstimator {
+  public:
+    RpmEstimator();
+    // sample and the millis() it was received at
+    void update(int32_t rpm, unsigned long stamp);
+    int32_t estimate(unsigned long now);
+    bool ready(void);
+    void reset(void);
+
+  private:
+    int32_t position; // rpm at lastStamp, Q8
+    int32_t rate;     // rpm per ms, Q12
+    unsigned long lastStamp;
+    bool started;
+};
+
+#endif
@@ -0,0 +1,223 @@
+#include "oledDisplay.h"
+#include <Wire.h>
+
+#define OLED_CONTROL_COMMAND 0x00
+#define OLED_CONTROL_DATA 0x40
+#define OLED_SET_COLUMN_ADDRESS 0x21
+#define OLED_SET_PAGE_ADDRESS 0x22
+
+// 128x64, internal charge pump, horizontal addressing
+const uint8_t OLED_INIT_SEQUENCE[] PROGMEM = {
+  0xAE,       // display off
+  0xD5, 0x80, // clock divide ratio
+  0xA8, 0x3F, // multiplex 64
+  0xD3, 0x00, // no display offset
+  0x40,       // start line 0
+  0x8D, 0x14, // charge pump on
+  0x20, 0x00, // horizontal addressing mode
+  0xA1,       // column 127 mapped to SEG0
+  0xC8,       // COM scan from the bottom
+  0xDA, 0x12, // COM pins
+  0x81, 0xCF, // contrast
+  0xD9, 0xF1, // pre-charge period
+  0xDB, 0x40, // VCOMH deselect level
+  0xA4,       // display RAM content
+  0xA6,       // normal, not inverted
+  0x2E,       // no scrolling
+  0xAF,       // display on
+};
+
+OledDisplay::OledDisplay(int8_t reset_pin) :
+  Adafruit_GFX(OLED_WIDTH_PX, OLED_HEIGHT_PX),
+  resetPin(reset_pin),
+  address(0x3C)
+{
+  memset(buffer, 0, sizeof(buffer));
+#ifdef OLED_STRIP_MODE
+  page = 0;
+#endif
+  invalidate();
+}
+
+void OledDisplay::begin(uint8_t i2c_address) {
+  address = i2c_address;
+  Wire.begin();
+  if(resetPin >= 0) {
+    pinMode(resetPin, OUTPUT);
+    digitalWrite(resetPin, HIGH);
+    delay(1);
+    digitalWrite(resetPin, LOW);
+    delay(10);
+    digitalWrite(resetPin, HIGH);
+  }
+  for(uint8_t i = 0; i < sizeof(OLED_INIT_SEQUENCE); i++) {
+    command(pgm_read_byte(OLED_INIT_SEQUENCE + i));
+  }
+  invalidate();
+}
+
+void OledDisplay::command(uint8_t cmd) {
+  Wire.beginTransmission(address);
+  Wire.write(OLED_CONTROL_COMMAND);
+  Wire.write(cmd);
+  Wire.endTransmission();
+}
+
+void OledDisplay::sendWindow(uint8_t page, uint8_t first, uint8_t last, const uint8_t* data) {
+  // window of the span, data bytes then fill it left to right
+  Wire.beginTransmission(address);
+  Wire.write(OLED_CONTROL_COMMAND);
+  Wire.write(OLED_SET_COLUMN_ADDRESS);
+  Wire.write(first);
+  Wire.write(last);
+  Wire.write(OLED_SET_PAGE_ADDRESS);
+  Wire.write(page);
+  Wire.write(page);
+  Wire.endTransmission();
+  const uint8_t* end = data + (last - first + 1);
+  while(data < end) {
+    Wire.beginTransmission(address);
+    Wire.write(OLED_CONTROL_DATA);
+    for(uint8_t n = 0; n < OLED_I2C_CHUNK && data < end; n++) Wire.write(*data++);
+    Wire.endTransmission();
+  }
+}
+
+#ifdef OLED_STRIP_MODE
+
+void OledDisplay::writeByte(uint16_t index, uint8_t value) {
+  buffer[index] = value;
+}
+
+void OledDisplay::invalidate() {
+  pagesShown = 0;
+}
+
+void OledDisplay::clearDisplay() {
+  memset(buffer, 0, sizeof(buffer));
+}
+
+// CRC-16/CCITT-FALSE of a page
+static uint16_t pageChecksum(const uint8_t* data) {
+  uint16_t crc = 0xFFFF;
+  for(uint8_t i = 0; i < OLED_WIDTH_PX; i++) {
+    crc ^= (uint16_t)data[i] << 8;
+    for(uint8_t bit = 0; bit < 8; bit++) {
+      crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+  }
+  return crc;
+}
+
+uint16_t OledDisplay::render(oled_draw_callback_t draw) {
+  uint16_t sent = 0;
+  for(page = 0; page < OLED_PAGES; page++) {
+    clearDisplay();
+    draw();
+    uint16_t crc = pageChecksum(buffer);
+    uint8_t mask = 1 << page;
+    if((pagesShown & mask) && crc == pageCrc[page]) continue;
+    pagesShown |= mask;
+    pageCrc[page] = crc;
+    sendWindow(page, 0, OLED_WIDTH_PX - 1, buffer);
+    sent += OLED_WIDTH_PX;
+  }
+  page = 0;
+  return sent;
+}
+
+#else
+
+void OledDisplay::markDirty(uint8_t page, uint8_t column) {
+  if(column < dirtyFirst[page]) dirtyFirst[page] = column;
+  if(column > dirtyLast[page]) dirtyLast[page] = column;
+}
+
+void OledDisplay::writeByte(uint16_t index, uint8_t value) {
+  if(buffer[index] == value) return;
+  buffer[index] = value;
+  markDirty(index / OLED_WIDTH_PX, index % OLED_WIDTH_PX);
+}
+
+void OledDisplay::invalidate() {
+  memset(dirtyFirst, 0, sizeof(dirtyFirst));
+  memset(dirtyLast, OLED_WIDTH_PX - 1, sizeof(dirtyLast));
+}
+
+void OledDisplay::clearDisplay() {
+  for(uint16_t i = 0; i < OLED_BUFFER_SIZE; i++) writeByte(i, 0);
+}
+
+uint16_t OledDisplay::display() {
+  uint16_t sent = 0;
+  for(uint8_t page = 0; page < OLED_PAGES; page++) {
+    if(dirtyFirst[page] > dirtyLast[page]) continue;
+    sendWindow(page, dirtyFirst[page], dirtyLast[page], buffer + page * OLED_WIDTH_PX + dirtyFirst[page]);
+    sent += dirtyLast[page] - dirtyFirst[page] + 1;
+    dirtyFirst[page] = OLED_WIDTH_PX;
+    dirtyLast[page] = 0;
+  }
+  return sent;
+}
+
+uint16_t OledDisplay::render(oled_draw_callback_t draw) {
+  clearDisplay();
+  draw();
+  return display();
+}
+
+#endif
+
+void OledDisplay::drawPixel(int16_t x, int16_t y, uint16_t color) {
+  switch(getRotation()) {
+    case 1:
+      _swap_int16_t(x, y);
+      x = WIDTH - x - 1;
+      break;
+    case 2:
+      x = WIDTH - x - 1;
+      y = HEIGHT - y - 1;
+      break;
+    case 3:
+      _swap_int16_t(x, y);
+      y = HEIGHT - y - 1;
+      break;
+  }
+  if(x < 0 || x >= OLED_WIDTH_PX || y < 0 || y >= OLED_HEIGHT_PX) return;
+#ifdef OLED_STRIP_MODE
+  if(y / 8 != page) return;
+  uint16_t index = x;
+#else
+  uint16_t index = (y / 8) * OLED_WIDTH_PX + x;
+#endif
+  uint8_t bit = 1 << (y & 7);
+  uint8_t value = buffer[index];
+  switch(color) {
+    case WHITE: value |= bit; break;
+    case BLACK: value &= ~bit; break;
+    case INVERSE: value ^= bit; break;
+  }
+  writeByte(index, value);
+}
+
+void OledDisplay::restoreBackground(const uint8_t* image, int16_t x, int16_t y, int16_t w, int16_t h) {
+  if(x < 0) { w += x; x = 0; }
+  if(y < 0) { h += y; y = 0; }
+  if(x + w > OLED_WIDTH_PX) w = OLED_WIDTH_PX - x;
+  if(y + h > OLED_HEIGHT_PX) h = OLED_HEIGHT_PX - y;
+  if(w <= 0 || h <= 0) return;
+  for(uint8_t image_page = y / 8; image_page <= (y + h - 1) / 8; image_page++) {
+    const uint8_t* source = image + image_page * OLED_WIDTH_PX + x;
+#ifdef OLED_STRIP_MODE
+    if(image_page != page) continue;
+    uint16_t index = x;
+#else
+    uint16_t index = image_page * OLED_WIDTH_PX + x;
+#endif
+    for(int16_t column = 0; column < w; column++) writeByte(index++, pgm_read_byte(source++));
+  }
+}
+
+void OledDisplay::drawBackground(const uint8_t* image) {
+  restoreBackground(image, 0, 0, OLED_WIDTH_PX, OLED_HEIGHT_PX);
+}
@@ -0,0 +1,86 @@
+#ifndef _OLED_DISPLAY_H
+#define _OLED_DISPLAY_H
+
+#include <Arduino.h>
+#include <Adafruit_GFX.h>
+
+// SSD1306 128x64 on I2C. The frame buffer is kept in the panel layout: one
+// byte is 8 vertical pixels of a page (LSB on top). Bytes that change are
+// recorded as a column span per page and display() only sends these spans,
+// so a frame costs what changed rather than the whole 1 KB.
+//
+// With OLED_STRIP_MODE only one page (128 bytes) is kept in RAM. A frame is
+// drawn by render(): the callback runs once per page, pixels outside of the
+// page are dropped, and the page is sent unless its CRC is the one of the
+// previous frame.
+
+#define OLED_WIDTH_PX 128
+#define OLED_HEIGHT_PX 64
+#define OLED_PAGES (OLED_HEIGHT_PX / 8)
+#ifdef OLED_STRIP_MODE
+#define OLED_BUFFER_SIZE OLED_WIDTH_PX
+#else
+#define OLED_BUFFER_SIZE (OLED_WIDTH_PX * OLED_PAGES)
+#endif
+// Wire buffers 32 bytes, one goes to the control byte
+#define OLED_I2C_CHUNK 31
+
+#ifndef BLACK
+#define BLACK 0
+#endif
+#ifndef WHITE
+#define WHITE 1
+#endif
+#ifndef INVERSE
+#define INVERSE 2
+#endif
+
+// draws a whole frame, see render()
+typedef void (*oled_draw_callback_t)(void);
+
+class OledDisplay : public Adafruit_GFX {
+  public:
+    // reset_pin < 0 when the panel reset isn't wired
+    OledDisplay(int8_t reset_pin = -1);
+    void begin(uint8_t i2c_address = 0x3C);
+    void clearDisplay(void);
+#ifndef OLED_STRIP_MODE
+    // sends the changed spans, returns the number of data bytes written
+    uint16_t display(void);
+#endif
+    // draws the frame on a blank screen and sends it, returns the number of
+    // data bytes written
+    uint16_t render(oled_draw_callback_t draw);
+    void drawPixel(int16_t x, int16_t y, uint16_t color);
+    // copies a PROGMEM image in the panel layout (see tools/gen_dial_face.py)
+    // over the pages covering the rectangle, it is meant for backgrounds:
+    // whatever else was drawn on these pages has to be drawn again
+    void restoreBackground(const uint8_t* image, int16_t x, int16_t y, int16_t w, int16_t h);
+    void drawBackground(const uint8_t* image);
+    // forces the next display() to send the whole screen
+    void invalidate(void);
+
+  private:
+    void command(uint8_t cmd);
+    void sendWindow(uint8_t page, uint8_t first, uint8_t last, const uint8_t* data);
+    void writeByte(uint16_t index, uint8_t value);
+
+    uint8_t buffer[OLED_BUFFER_SIZE];
+#ifdef OLED_STRIP_MODE
+    // page being drawn by render()
+    uint8_t page;
+    uint16_t pageCrc[OLED_PAGES];
+    // bit set when the panel holds the page of pageCrc
+    uint8_t pagesShown;
+#else
+    void markDirty(uint8_t page, uint8_t column);
+
+    // first and last dirty column of each page, first > last when clean
+    uint8_t dirtyFirst[OLED_PAGES];
+    uint8_t dirtyLast[OLED_PAGES];
+#endif
+    int8_t resetPin;
+    uint8_t address;
+};
+
+#endif
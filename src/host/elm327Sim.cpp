@@ -0,0 +1,403 @@
+#include "elm327Sim.h"
+
+#define SIM_ID "ELM327 v1.5"
+#define SIM_DEFAULT_BAUD 38400
+// ATBRT default, x5 ms
+#define SIM_BAUD_TIMEOUT 0x4B
+#define SIM_ECUS 2
+#define SIM_ENGINE_ECU 0
+
+const elm327_sim_conf_t ELM327_SIM_DEFAULTS = {
+  .latency = 30,
+  .jitter = 10,
+  .searchTime = 2000,
+  .noDataPercent = 0,
+  .garblePerMille = 0,
+  .ecuCount = 1,
+  .protocol = '6',
+  .baudSwitch = true,
+  .maxBaud = 500000,
+  .seed = 1
+};
+
+// PIDs each ECU answers, bitmap requests (0x00, 0x20...) apart. 0x20 in a
+// list means the next range is supported.
+static const uint8_t ENGINE_PIDS[] = { 0x04, 0x05, 0x0C, 0x0D, 0x0F, 0x11, 0x20, 0x2F };
+static const uint8_t GEARBOX_PIDS[] = { 0x0D, 0x1F };
+
+Elm327Sim::Elm327Sim(const elm327_sim_conf_t& config) :
+  requests(0), noData(0), garbled(0), bytesOut(0), bytesIn(0),
+  config(config), head(0), count(0), lastByteAt(0), lineLength(0),
+  linkBaud(SIM_DEFAULT_BAUD), readerBaud(SIM_DEFAULT_BAUD), baudSwitching(false),
+  random(config.seed ? config.seed : 1)
+{
+  if(this->config.ecuCount < 1) this->config.ecuCount = 1;
+  if(this->config.ecuCount > SIM_ECUS) this->config.ecuCount = SIM_ECUS;
+  reset();
+}
+
+// xorshift32, runs are reproducible from the seed
+uint32_t Elm327Sim::nextRandom() {
+  random ^= random << 13;
+  random ^= random >> 17;
+  random ^= random << 5;
+  return random;
+}
+
+unsigned long long Elm327Sim::now() {
+  return micros();
+}
+
+void Elm327Sim::reset() {
+  echo = true;
+  spaces = true;
+  headers = false;
+  linefeeds = true;
+  selectedProtocol = '0';
+  connected = false;
+  baudTimeout = SIM_BAUD_TIMEOUT;
+}
+
+void Elm327Sim::begin(unsigned long baud) {
+  readerBaud = baud;
+}
+
+void Elm327Sim::checkBaudSwitch() {
+  if(!baudSwitching || now() < baudDeadline) return;
+  // no '\r' at the new rate in time, back to the old one
+  baudSwitching = false;
+  linkBaud = previousBaud;
+  startAnswer(0);
+  send('>');
+}
+
+int Elm327Sim::available() {
+  checkBaudSwitch();
+  if(count == 0) return 0;
+  unsigned long long clock = now();
+  // nothing to do until the next byte lands, skip the wait
+  if(readyAt[head] > clock) arduinoShimAdvance(readyAt[head] - clock);
+  clock = now();
+  uint16_t ready = 0;
+  while(ready < count && readyAt[(head + ready) % ELM327_SIM_QUEUE] <= clock) ready++;
+  return ready;
+}
+
+int Elm327Sim::peek() {
+  if(available() == 0) return -1;
+  return queue[head];
+}
+
+int Elm327Sim::read() {
+  if(available() == 0) return -1;
+  uint8_t value = queue[head];
+  // sent at another rate than the reader listens to
+  if(sentAt[head] != readerBaud) value = 0x80 | (nextRandom() & 0x7F);
+  head = (head + 1) % ELM327_SIM_QUEUE;
+  count--;
+  return value;
+}
+
+size_t Elm327Sim::write(uint8_t value) {
+  checkBaudSwitch();
+  bytesIn++;
+  // the adapter can't make sense of a byte at the wrong rate
+  if(readerBaud != linkBaud) return 1;
+  if(baudSwitching) {
+    if(value == '\r') {
+      baudSwitching = false;
+      startAnswer(0);
+      sendLine("OK");
+      endAnswer();
+    }
+    return 1;
+  }
+  if(echo) {
+    startAnswer(0);
+    send(value);
+  }
+  if(value == '\r') {
+    line[lineLength] = '\0';
+    handleLine();
+    lineLength = 0;
+  }
+  else if(value != ' ' && value != '\n' && lineLength < ELM327_SIM_LINE - 1) {
+    line[lineLength++] = toupper(value);
+  }
+  return 1;
+}
+
+// the next bytes are readable delay_ms from now, after what is queued
+void Elm327Sim::startAnswer(unsigned long delay_ms) {
+  answerAt = now() + (unsigned long long)delay_ms * 1000;
+}
+
+void Elm327Sim::send(char value) {
+  if(count == ELM327_SIM_QUEUE) return;
+  if(config.garblePerMille > 0 && nextRandom() % 1000 < config.garblePerMille) {
+    value ^= 1 << (nextRandom() % 7);
+    garbled++;
+  }
+  // 10 bits per byte on the wire
+  unsigned long long at = lastByteAt > answerAt ? lastByteAt : answerAt;
+  at += 10000000ULL / linkBaud;
+  uint16_t tail = (head + count) % ELM327_SIM_QUEUE;
+  queue[tail] = value;
+  readyAt[tail] = at;
+  sentAt[tail] = linkBaud;
+  count++;
+  lastByteAt = at;
+  bytesOut++;
+}
+
+void Elm327Sim::sendText(const char* text) {
+  while(*text) send(*text++);
+}
+
+void Elm327Sim::sendLine(const char* text) {
+  sendText(text);
+  send('\r');
+  if(linefeeds) send('\n');
+}
+
+void Elm327Sim::sendHex(uint8_t value) {
+  static const char DIGITS[] = "0123456789ABCDEF";
+  send(DIGITS[value >> 4]);
+  send(DIGITS[value & 0x0F]);
+}
+
+// blank line and prompt
+void Elm327Sim::endAnswer() {
+  send('\r');
+  if(linefeeds) send('\n');
+  send('>');
+}
+
+void Elm327Sim::handleLine() {
+  if(lineLength == 0) {
+    startAnswer(0);
+    endAnswer();
+    return;
+  }
+  if(strncmp(line, "AT", 2) == 0) handleAt(line + 2);
+  else if(strncmp(line, "01", 2) == 0) handleMode01(line + 2);
+  else {
+    startAnswer(config.latency);
+    sendLine("?");
+    endAnswer();
+  }
+}
+
+void Elm327Sim::handleAt(const char* cmd) {
+  startAnswer(1);
+  if(strcmp(cmd, "Z") == 0 || strcmp(cmd, "WS") == 0) {
+    // ATZ also brings the link back to its default rate
+    if(cmd[0] == 'Z') linkBaud = SIM_DEFAULT_BAUD;
+    reset();
+    send('\r');
+    sendLine("");
+    sendLine(SIM_ID);
+    endAnswer();
+    return;
+  }
+  if(strcmp(cmd, "I") == 0) sendLine(SIM_ID);
+  else if(strcmp(cmd, "RV") == 0) sendLine("12.6V");
+  else if(cmd[0] == 'E' && (cmd[1] == '0' || cmd[1] == '1') && !cmd[2]) { echo = cmd[1] == '1'; sendLine("OK"); }
+  else if(cmd[0] == 'S' && (cmd[1] == '0' || cmd[1] == '1') && !cmd[2]) { spaces = cmd[1] == '1'; sendLine("OK"); }
+  else if(cmd[0] == 'H' && (cmd[1] == '0' || cmd[1] == '1') && !cmd[2]) { headers = cmd[1] == '1'; sendLine("OK"); }
+  else if(cmd[0] == 'L' && (cmd[1] == '0' || cmd[1] == '1') && !cmd[2]) { linefeeds = cmd[1] == '1'; sendLine("OK"); }
+  else if(strncmp(cmd, "AT", 2) == 0 && cmd[2] >= '0' && cmd[2] <= '2' && !cmd[3]) sendLine("OK");
+  else if(strncmp(cmd, "ST", 2) == 0 && strlen(cmd) == 4) sendLine("OK");
+  else if(strncmp(cmd, "BRT", 3) == 0 && strlen(cmd) == 5) {
+    baudTimeout = strtoul(cmd + 3, NULL, 16);
+    sendLine("OK");
+  }
+  else if(strncmp(cmd, "SP", 2) == 0 && strlen(cmd) == 3) {
+    selectedProtocol = cmd[2] == 'A' && false ? '0' : cmd[2];
+    connected = false;
+    sendLine("OK");
+  }
+  else if(strcmp(cmd, "DPN") == 0) {
+    char protocol[3] = { 0 };
+    if(selectedProtocol == '0') {
+      protocol[0] = 'A';
+      protocol[1] = connected ? config.protocol : '0';
+    }
+    else protocol[0] = selectedProtocol;
+    sendLine(protocol);
+  }
+  else if(strncmp(cmd, "BRD", 3) == 0 && strlen(cmd) == 5) {
+    unsigned long divisor = strtoul(cmd + 3, NULL, 16);
+    if(!config.baudSwitch || divisor == 0) {
+      sendLine("?");
+    }
+    else {
+      // OK at the old rate, the id at the new one, then wait for '\r'
+      sendLine("OK");
+      previousBaud = linkBaud;
+      linkBaud = 4000000UL / divisor;
+      sendText(SIM_ID);
+      send('\r');
+      baudSwitching = true;
+      baudDeadline = lastByteAt + (unsigned long long)baudTimeout * 5000;
+      return;
+    }
+  }
+  else sendLine("?");
+  endAnswer();
+}
+
+bool Elm327Sim::ecuSupports(uint8_t ecu, uint8_t pid) {
+  const uint8_t* pids = ecu == SIM_ENGINE_ECU ? ENGINE_PIDS : GEARBOX_PIDS;
+  uint8_t length = ecu == SIM_ENGINE_ECU ? sizeof(ENGINE_PIDS) : sizeof(GEARBOX_PIDS);
+  for(uint8_t i = 0; i < length; i++) {
+    if(pids[i] == pid) return true;
+  }
+  return false;
+}
+
+// data bytes of a PID from a car slowly warming up while revving between
+// idle and 4200 rpm, returns the number of bytes, 0 when not supported
+uint8_t Elm327Sim::pidData(uint8_t ecu, uint8_t pid, uint8_t* data) {
+  if(pid % 0x20 == 0) {
+    // any supported PID of the range, or the next range flag
+    bool any = false;
+    memset(data, 0, 4);
+    for(uint8_t i = 1; i <= 0x20; i++) {
+      if(ecuSupports(ecu, pid + i)) {
+        data[(i - 1) / 8] |= 0x80 >> ((i - 1) % 8);
+        any = true;
+      }
+    }
+    return any ? 4 : 0;
+  }
+  if(!ecuSupports(ecu, pid)) return 0;
+
+  float seconds = millis() / 1000.0;
+  float rpm = 800 + 1700 * (1 - cos(2 * PI * seconds / 8));
+  float load = 15 + 60 * (rpm - 800) / 3400;
+  switch(pid) {
+    case 0x04:
+    case 0x11:
+      data[0] = load * 255 / 100;
+      return 1;
+    case 0x05:
+      data[0] = 40 + 20 + (seconds * 2 < 70 ? seconds * 2 : 70);
+      return 1;
+    case 0x0C: {
+      uint16_t raw = rpm * 4;
+      data[0] = raw >> 8;
+      data[1] = raw & 0xFF;
+      return 2;
+    }
+    case 0x0D:
+      data[0] = rpm / 40;
+      return 1;
+    case 0x0F:
+      data[0] = 40 + 25;
+      return 1;
+    case 0x1F: {
+      uint16_t run_time = seconds;
+      data[0] = run_time >> 8;
+      data[1] = run_time & 0xFF;
+      return 2;
+    }
+    case 0x2F:
+      data[0] = 60 * 255 / 100;
+      return 1;
+  }
+  return 0;
+}
+
+// one line for a single frame, otherwise the ISO-TP byte count line and
+// the indexed frames, padded like on the bus
+void Elm327Sim::sendMessage(const uint8_t* data, uint8_t length) {
+  bool can = config.protocol >= '6';
+  if(!can || length <= 7) {
+    for(uint8_t i = 0; i < length; i++) {
+      if(spaces && i > 0) send(' ');
+      sendHex(data[i]);
+    }
+    send('\r');
+    if(linefeeds) send('\n');
+    return;
+  }
+  char count[4];
+  snprintf(count, sizeof(count), "%03X", length);
+  sendLine(count);
+  uint8_t i = 0;
+  for(uint8_t frame = 0; i < length; frame++) {
+    send("0123456789ABCDEF"[frame & 0x0F]);
+    send(':');
+    uint8_t frame_bytes = frame == 0 ? 6 : 7;
+    for(uint8_t k = 0; k < frame_bytes; k++, i++) {
+      if(spaces) send(' ');
+      sendHex(i < length ? data[i] : 0x00);
+    }
+    send('\r');
+    if(linefeeds) send('\n');
+  }
+}
+
+void Elm327Sim::handleMode01(const char* cmd) {
+  uint8_t pids[6];
+  uint8_t pidCount = 0;
+  uint8_t length = strlen(cmd);
+
+  // an odd length ends with the number of answers to wait for
+  if(length % 2) length--;
+  for(uint8_t i = 0; i < length; i += 2) {
+    char byte[3] = { cmd[i], cmd[i + 1], '\0' };
+    char* end;
+    long value = strtol(byte, &end, 16);
+    if(*end != '\0' || pidCount == sizeof(pids)) {
+      startAnswer(config.latency);
+      sendLine("?");
+      endAnswer();
+      return;
+    }
+    pids[pidCount++] = value;
+  }
+
+  unsigned long delay_ms = config.latency + (config.jitter ? nextRandom() % (config.jitter + 1) : 0);
+  startAnswer(delay_ms);
+  if(!connected) {
+    if(selectedProtocol == '0') {
+      sendLine("SEARCHING...");
+      startAnswer(delay_ms + config.searchTime);
+    }
+    else if(selectedProtocol != config.protocol) {
+      startAnswer(delay_ms + config.searchTime);
+      sendLine("UNABLE TO CONNECT");
+      endAnswer();
+      return;
+    }
+    connected = true;
+  }
+
+  bool answered = false;
+  if(pidCount > 0 && (config.noDataPercent == 0 || nextRandom() % 100 >= config.noDataPercent)) {
+    for(uint8_t ecu = 0; ecu < config.ecuCount; ecu++) {
+      uint8_t message[1 + 6 * 5];
+      uint8_t size = 0;
+      message[size++] = 0x41;
+      // legacy protocols only carry the first PID of a request
+      uint8_t served = config.protocol >= '6' ? pidCount : 1;
+      for(uint8_t i = 0; i < served; i++) {
+        uint8_t bytes = pidData(ecu, pids[i], message + size + 1);
+        if(bytes == 0) continue;
+        message[size] = pids[i];
+        size += 1 + bytes;
+      }
+      if(size == 1) continue;
+      sendMessage(message, size);
+      answered = true;
+    }
+  }
+  if(answered) requests++;
+  else {
+    sendLine("NO DATA");
+    noData++;
+  }
+  endAnswer();
+}
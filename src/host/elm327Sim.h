@@ -0,0 +1,92 @@
+#ifndef _ELM327_SIM_H
+#define _ELM327_SIM_H
+
+#include <Arduino.h>
+#include <obdTransport.h>
+
+// In-process ELM327 with one car behind it, answers on the simulated clock
+// of the Arduino shim. Covers what ObdReader sends: resets, formatting
+// settings, ATBRD, protocol selection and mode 01 requests, batched ones
+// included (ISO-TP multi frame answers on CAN).
+
+#define ELM327_SIM_QUEUE 2048
+#define ELM327_SIM_LINE 32
+
+typedef struct {
+  uint16_t latency;        // ms between a request and the first answer byte
+  uint16_t jitter;         // up to this many ms randomly added to latency
+  uint16_t searchTime;     // ms of "SEARCHING..." on the first request after ATSP0
+  uint8_t noDataPercent;   // share of PID requests answered NO DATA
+  uint16_t garblePerMille; // share of answer bytes corrupted on the wire
+  uint8_t ecuCount;        // ECUs answering supported PID requests, 1 or 2
+  char protocol;           // protocol of the car, '1'..'C'
+  bool baudSwitch;         // ATBRD support
+  unsigned long maxBaud;   // rate reported to the reader as its limit
+  uint32_t seed;
+} elm327_sim_conf_t;
+
+extern const elm327_sim_conf_t ELM327_SIM_DEFAULTS;
+
+class Elm327Sim : public ObdTransport {
+  public:
+    Elm327Sim(const elm327_sim_conf_t& config);
+    void begin(unsigned long baud);
+    unsigned long maxBaud() { return config.maxBaud; }
+    int available();
+    int read();
+    int peek();
+    size_t write(uint8_t value);
+    using Print::write;
+
+    // counters
+    unsigned long requests;     // mode 01 requests answered with data
+    unsigned long noData;       // NO DATA answers
+    unsigned long garbled;      // corrupted bytes
+    unsigned long bytesOut;     // bytes sent to the reader
+    unsigned long bytesIn;      // bytes received from the reader
+  private:
+    elm327_sim_conf_t config;
+    // answer bytes and the simulated time (us) they are readable at
+    uint8_t queue[ELM327_SIM_QUEUE];
+    unsigned long long readyAt[ELM327_SIM_QUEUE];
+    unsigned long sentAt[ELM327_SIM_QUEUE];     // link rate of each byte
+    uint16_t head;
+    uint16_t count;
+    unsigned long long lastByteAt;
+    char line[ELM327_SIM_LINE];
+    uint8_t lineLength;
+    // adapter settings
+    bool echo;
+    bool spaces;
+    bool headers;
+    bool linefeeds;
+    char selectedProtocol;    // '0' for auto
+    bool connected;
+    uint8_t baudTimeout;      // ATBRT, x5 ms
+    unsigned long linkBaud;   // rate the adapter talks at
+    unsigned long readerBaud; // rate the reader talks at
+    unsigned long previousBaud;
+    bool baudSwitching;       // waiting for '\r' at the new rate
+    unsigned long long baudDeadline;
+    unsigned long long answerAt;
+    uint32_t random;
+
+    uint32_t nextRandom();
+    unsigned long long now();
+    void reset();
+    void startAnswer(unsigned long delay_ms);
+    void send(char value);
+    void sendText(const char* text);
+    void sendLine(const char* text);
+    void sendHex(uint8_t value);
+    void endAnswer();
+    void handleLine();
+    void handleAt(const char* cmd);
+    void handleMode01(const char* cmd);
+    void sendMessage(const uint8_t* data, uint8_t length);
+    uint8_t pidData(uint8_t ecu, uint8_t pid, uint8_t* data);
+    bool ecuSupports(uint8_t ecu, uint8_t pid);
+    void checkBaudSwitch();
+};
+
+#endif
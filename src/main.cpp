@@ -1,10 +1,18 @@
 #include <Arduino.h>
 #include "elm327.h"
+#include "pidScheduler.h"
+#include "dialGeometry.h"
+#include "rpmEstimator.h"
+#ifdef OBD_USE_HW_UART
+#include "uartTransport.h"
+#endif
 #include <Wire.h>
-#include <math.h>
 
 #include <Adafruit_GFX.h>
-#include <Adafruit_SSD1306.h>
+#include "oledDisplay.h"
+#ifndef DIAL_FACE_RUNTIME
+#include "dialFace.h"
+#endif
 
 /*
 This program is short to run on atmega328 because of the big memory footprint
@@ -14,6 +22,9 @@ because it's running out of space for dynamic mem allocation.
 To deal with that, I've used PROGMEM instruction whenever possible (readonly var)
 to put things into flash and save RAM. I'm also using the string helper F() which
 does the same for static strings.
+The OLED_STRIP_MODE build (env:uno_strip) goes further and keeps a single
+128 bytes page of the screen instead of the 1 KB frame buffer, the frame is
+drawn again for each of the 8 pages.
 */
 
 const int OLED_HEIGHT PROGMEM = 64;
@@ -33,39 +44,78 @@ const uint16_t LABEL_RADIUS PROGMEM = DIAL_RADIUS - 18;
 const int DIAL_LABEL_Y_OFFSET PROGMEM = 6;
 const int DIAL_LABEL_X_OFFSET PROGMEM = 4;
 
-const uint16_t MAJOR_TICKS[] PROGMEM= { 0, 1000, 2000, 3000, 4000, 5000 };
+constexpr uint16_t MAJOR_TICKS[] PROGMEM = { GAUGE_MAJOR_TICKS };
 const int MAJOR_TICK_COUNT PROGMEM = sizeof(MAJOR_TICKS) / sizeof(MAJOR_TICKS[0]);
 const int MAJOR_TICK_LENGTH PROGMEM = 11;
-const uint16_t MINOR_TICKS[] PROGMEM = { 500, 1500, 2500, 3500, 4500 };
+constexpr uint16_t MINOR_TICKS[] PROGMEM = { GAUGE_MINOR_TICKS };
 const int MINOR_TICK_COUNT PROGMEM = sizeof(MINOR_TICKS) / sizeof(MINOR_TICKS[0]);
 const int MINOR_TICK_LENGTH PROGMEM = 5;
 
-const uint16_t DIAL_MAX_RPM PROGMEM = MAJOR_TICKS[MAJOR_TICK_COUNT-1];
-const uint8_t HALF_CIRCLE_DEGREES PROGMEM = 180;
-const float PI_RADIANS PROGMEM = PI/HALF_CIRCLE_DEGREES;
+#ifndef DIAL_FACE_RUNTIME
+constexpr bool sameTicks(const uint16_t* ticks, const uint16_t* face_ticks, int count) {
+  return count == 0 || (*ticks == *face_ticks && sameTicks(ticks + 1, face_ticks + 1, count - 1));
+}
+constexpr uint16_t FACE_MAJOR_TICKS[] = { DIAL_FACE_MAJOR_TICKS };
+constexpr uint16_t FACE_MINOR_TICKS[] = { DIAL_FACE_MINOR_TICKS };
+static_assert(DIAL_FACE_MAX_RPM == GAUGE_MAX_RPM
+  && sizeof(FACE_MAJOR_TICKS) == sizeof(MAJOR_TICKS) && sameTicks(MAJOR_TICKS, FACE_MAJOR_TICKS, MAJOR_TICK_COUNT)
+  && sizeof(FACE_MINOR_TICKS) == sizeof(MINOR_TICKS) && sameTicks(MINOR_TICKS, FACE_MINOR_TICKS, MINOR_TICK_COUNT),
+  "src/dialFace.h doesn't match the gauge settings, regenerate it with tools/gen_dial_face.py");
+#endif
 
 void drawTicks(const uint16_t*, int, int);
-float getPercentMaxRpm(int);
-float getCircleXWithLengthAndAngle(uint16_t, float);
-float getCircleYWithLengthAndAngle(uint16_t, float);
 void drawMajorTickLabels(void);
 void drawIndicatorHand(int);
+void drawFrame(void);
+void drawInfo(void);
+void drawDial(void);
+void eraseIndicatorHand(void);
 void drawRpm(int);
 void drawCoolantTemp(int);
 void displayInfo(const __FlashStringHelper*);
+void logInfo(const __FlashStringHelper*);
+bool readFreshPid(uint8_t, int32_t*, unsigned long*);
 
 static error_code_t error;
 
-Adafruit_SSD1306 disp(4);
+OledDisplay disp(4);
+// needle top drawn on the screen, its bounding box is erased on the next frame
+static dial_point_t indicatorTop = { DIAL_CENTER_X, DIAL_CENTER_Y };
+static bool dialShown = false;
+// message drawn by drawInfo()
+static const __FlashStringHelper* infoText;
+#ifdef OBD_USE_HW_UART
+// the ELM327 is wired on RX/TX (pins 0/1), Serial can't be used for logs
+HardwareUartTransport obdLink;
+#endif
 ObdReader elm({
   .rxPin = 8,
-  .txPin = 9
+  .txPin = 9,
+#ifdef OBD_USE_HW_UART
+  .transport = &obdLink,
+#else
+  .transport = NULL,
+#endif
+  .profile = OBD_PROFILE_LOW_LATENCY
 });
+PidScheduler scheduler(elm);
+RpmEstimator rpmEstimator;
+// rpm the needle shows
 static int rpm = 0;
+static int coolantTemp = 0;
+static bool coolantTempChanged = false;
+static unsigned long lastFrame = 0;
+
+// refresh period (ms) and priority of each signal, 0 is the most important
+const uint16_t RPM_PERIOD PROGMEM = 50;
+const uint16_t COOLANT_TEMP_PERIOD PROGMEM = 5000;
 
 void setup() {
+#ifndef OBD_USE_HW_UART
   Serial.begin(9600);
-  disp.begin(SSD1306_SWITCHCAPVCC, 0x3C);
+  elm.setLogOutput(&Serial);
+#endif
+  disp.begin(0x3C);
   // F() is an helper used to store string into flash instead of RAM
   displayInfo(F("Setting up"));
   elm.enable_debug(true);
@@ -114,104 +164,162 @@ void setup() {
       break;
 
     case NO_ERROR:
+      scheduler.add(PID_RPM, RPM_PERIOD, 0);
+      scheduler.add(PID_COOLANT_TEMP, COOLANT_TEMP_PERIOD, 2);
       displayInfo(F("Setup done"));
-      Serial.println(F("Setup done"));
-      delay(1000);
+      logInfo(F("Setup done"));
       break;
 
     default:
       displayInfo(F("UKN error"));
-      Serial.println(F("Unknow error occured"));
+      logInfo(F("Unknow error occured"));
       exit(1);
       break;
   }
 }
 
 void loop() {
-  delay(50);
-  rpm = elm.getRpm();
-  if(rpm != 0) {
+  // never waits on the adapter, the scheduler only consumes available bytes
+  scheduler.run();
+  int32_t value;
+  unsigned long stamp;
+  if(readFreshPid(PID_RPM, &value, &stamp)) rpmEstimator.update(value, stamp);
+  if(readFreshPid(PID_COOLANT_TEMP, &value, &stamp)) {
+    coolantTemp = value;
+    coolantTempChanged = true;
+  }
+
+  // frames come at a fixed rate, whatever the OBD sample rate is
+  unsigned long now = millis();
+  if(!rpmEstimator.ready() || now - lastFrame < GAUGE_FRAME_PERIOD) return;
+  lastFrame = now;
+  int needle_rpm = rpmEstimator.estimate(now);
+  bool rpm_updated = needle_rpm != rpm || !dialShown;
+  bool temp_updated = coolantTempChanged || !dialShown;
+  if(!rpm_updated && !temp_updated) return;
+  rpm = needle_rpm;
+  coolantTempChanged = false;
+#ifdef OLED_STRIP_MODE
+  // pages that come out the same as on the screen are not sent
+  disp.render(drawFrame);
+  dialShown = true;
+#else
+  if(!dialShown) {
+    // first frame after the setup messages
     disp.clearDisplay();
-    drawRpm(rpm);
-    disp.display();
+    drawDial();
+    dialShown = true;
   }
+  // only what is redrawn differently goes to the panel
+  if(temp_updated) drawCoolantTemp(coolantTemp);
+  if(rpm_updated) drawRpm(rpm);
+  disp.display();
+#endif
+}
+
+bool readFreshPid(uint8_t pid, int32_t* value, unsigned long* stamp) {
+  int32_t fixed;
+  if(!elm.hasFreshPid(pid) || !elm.readPid(pid, &fixed, stamp)) return false;
+  *value = fixed / PID_FIXED_ONE;
+  return true;
+}
+
+void logInfo(const __FlashStringHelper* text) {
+#ifndef OBD_USE_HW_UART
+  Serial.println(text);
+#endif
 }
 
 void displayInfo(const __FlashStringHelper* text) {
-  disp.clearDisplay();
+  infoText = text;
+  disp.render(drawInfo);
+  dialShown = false;
+}
+
+void drawInfo() {
   disp.setCursor(0, OLED_HEIGHT/2);
   disp.setTextSize(TEXT_SIZE_LARGE);
   disp.setTextColor(WHITE);
-  disp.print(text);
-  disp.display();
+  disp.print(infoText);
 }
 
-void drawRpm(int rpm) {
+void drawFrame() {
+  drawDial();
+  drawCoolantTemp(coolantTemp);
+  drawIndicatorHand(rpm);
+}
+
+void drawDial() {
+#ifdef DIAL_FACE_RUNTIME
   disp.drawCircle(DIAL_CENTER_X, DIAL_CENTER_Y, DIAL_RADIUS, WHITE);
   drawTicks(MAJOR_TICKS, MAJOR_TICK_COUNT, MAJOR_TICK_LENGTH);
   drawTicks(MINOR_TICKS, MINOR_TICK_COUNT, MINOR_TICK_LENGTH);
   drawMajorTickLabels();
+#else
+  // circle, ticks and labels never change: they are rendered once by
+  // tools/gen_dial_face.py and copied from flash, only the hand is computed
+  disp.drawBackground(DIAL_FACE);
+#endif
+}
+
+void drawRpm(int rpm) {
+  eraseIndicatorHand();
   drawIndicatorHand(rpm);
 }
 
+void eraseIndicatorHand() {
+  int16_t left = min(DIAL_CENTER_X - INDICATOR_WIDTH / 2, indicatorTop.x);
+  int16_t right = max(DIAL_CENTER_X + INDICATOR_WIDTH / 2, indicatorTop.x);
+  int16_t top = min(DIAL_CENTER_Y, indicatorTop.y);
+#ifdef DIAL_FACE_RUNTIME
+  disp.fillRect(left, top, right - left + 1, DIAL_CENTER_Y - top + 1, BLACK);
+  drawDial();
+#else
+  disp.restoreBackground(DIAL_FACE, left, top, right - left + 1, DIAL_CENTER_Y - top + 1);
+#endif
+}
+
 void drawTicks(const uint16_t ticks[], int tick_count, int tick_length) {
   for (int tick_index = 0; tick_index < tick_count; tick_index++) {
     // this array is stored in flash so need to use pgm_read_word to get value
-		int rpm_tick_value = (int)pgm_read_word(ticks + tick_index);
-		float tick_angle = (HALF_CIRCLE_DEGREES * getPercentMaxRpm(rpm_tick_value)) + HALF_CIRCLE_DEGREES;
-		uint16_t dial_x = getCircleXWithLengthAndAngle(DIAL_RADIUS - 1, tick_angle);
-		uint16_t dial_y = getCircleYWithLengthAndAngle(DIAL_RADIUS - 1, tick_angle);
-		uint16_t tick_x = getCircleXWithLengthAndAngle(DIAL_RADIUS - tick_length, tick_angle);
-		uint16_t tick_y = getCircleYWithLengthAndAngle(DIAL_RADIUS - tick_length, tick_angle);
-		disp.drawLine(dial_x, dial_y, tick_x, tick_y, WHITE);
-	}
-}
-
-float getPercentMaxRpm(int value) {
-	float ret_value = (value * 1.0)/(DIAL_MAX_RPM * 1.0);
-	return ret_value;
+    dial_angle_t tick_angle = dialAngle(pgm_read_word(ticks + tick_index));
+    dial_point_t dial = dialPoint(DIAL_CENTER_X, DIAL_CENTER_Y, DIAL_RADIUS - 1, tick_angle);
+    dial_point_t tick = dialPoint(DIAL_CENTER_X, DIAL_CENTER_Y, DIAL_RADIUS - tick_length, tick_angle);
+    disp.drawLine(dial.x, dial.y, tick.x, tick.y, WHITE);
+  }
 }
 
-float getCircleXWithLengthAndAngle(uint16_t radius, float angle) {
-	return DIAL_CENTER_X + radius * cos(angle*PI_RADIANS);
-};
-
-float getCircleYWithLengthAndAngle(uint16_t radius, float angle) {
-	return DIAL_CENTER_Y + radius * sin(angle*PI_RADIANS);
-};
-
 void drawMajorTickLabels() {
-	disp.setTextSize(TEXT_SIZE_SMALL);
+  disp.setTextSize(TEXT_SIZE_SMALL);
   disp.setTextColor(WHITE);
-	for (int label_index = 0; label_index < MAJOR_TICK_COUNT; label_index++) {
+  for (int label_index = 0; label_index < MAJOR_TICK_COUNT; label_index++) {
     // draw only half labels
     if(label_index% 2==0) continue;
     // this array is stored in flash so need to use pgm_read_word to get value
-		int rpm_tick_value = pgm_read_word(MAJOR_TICKS + label_index);
-		float tick_angle = (HALF_CIRCLE_DEGREES	* getPercentMaxRpm(rpm_tick_value)) + HALF_CIRCLE_DEGREES;
-		uint16_t dial_x = getCircleXWithLengthAndAngle(LABEL_RADIUS, tick_angle);
-		uint16_t dial_y = getCircleYWithLengthAndAngle(LABEL_RADIUS, tick_angle);
-		disp.setCursor(dial_x - DIAL_LABEL_X_OFFSET, dial_y - DIAL_LABEL_Y_OFFSET);
-		int label_value = rpm_tick_value / ONE_K;
-		disp.print(label_value);
-	}
+    int rpm_tick_value = pgm_read_word(MAJOR_TICKS + label_index);
+    dial_point_t label = dialPoint(DIAL_CENTER_X, DIAL_CENTER_Y, LABEL_RADIUS, dialAngle(rpm_tick_value));
+    disp.setCursor(label.x - DIAL_LABEL_X_OFFSET, label.y - DIAL_LABEL_Y_OFFSET);
+    int label_value = rpm_tick_value / ONE_K;
+    disp.print(label_value);
+  }
 }
 
 void drawIndicatorHand(int rpm_value) {
-  float indicator_angle = (HALF_CIRCLE_DEGREES * getPercentMaxRpm(rpm_value)) + HALF_CIRCLE_DEGREES;
-  uint16_t indicator_top_x = getCircleXWithLengthAndAngle(INDICATOR_LENGTH, indicator_angle);
-  uint16_t indicator_top_y = getCircleYWithLengthAndAngle(INDICATOR_LENGTH, indicator_angle);
+  // the needle stays at the end of the dial above GAUGE_MAX_RPM
+  indicatorTop = dialPoint(DIAL_CENTER_X, DIAL_CENTER_Y, INDICATOR_LENGTH, dialAngle(rpm_value));
 
-	disp.drawTriangle(DIAL_CENTER_X - INDICATOR_WIDTH / 2,
+  disp.drawTriangle(DIAL_CENTER_X - INDICATOR_WIDTH / 2,
                     DIAL_CENTER_Y,DIAL_CENTER_X + INDICATOR_WIDTH / 2,
                     DIAL_CENTER_Y,
-                    indicator_top_x,
-                    indicator_top_y,
+                    indicatorTop.x,
+                    indicatorTop.y,
                     WHITE);
 }
 
 void drawCoolantTemp(int temp) {
+  disp.fillRect(0, 0, OLED_WIDTH, SEGMENT_HEIGHT, BLACK);
   disp.setCursor(0, 0);
+  disp.setTextColor(WHITE);
 
   disp.setTextSize(TEXT_SIZE_LARGE);
   disp.print(F("TEMP: "));
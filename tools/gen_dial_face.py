@@ -0,0 +1,205 @@
+#!/usr/bin/env python3
+"""
+Render the static part of the RPM dial (circle, ticks, labels) exactly like
+drawRpm() used to do it at run time with Adafruit GFX, and print it as a C
+header holding a PROGMEM bitmap in the SSD1306 page layout, ready for
+OledDisplay::drawBackground().
+
+    python3 tools/gen_dial_face.py > src/dialFace.h
+
+The geometry below mirrors the constants of src/main.cpp. Run it again
+whenever they change, passing the same rpm settings as the build flags:
+
+    python3 tools/gen_dial_face.py --max-rpm 7000 \
+        --major-ticks 0,1000,2000,3000,4000,5000,6000,7000 \
+        --minor-ticks 500,1500,2500,3500,4500,5500,6500 > src/dialFace.h
+ Float maths is rounded to 32 bits after every step
+because double is a float on AVR.
+"""
+import argparse
+import math
+import struct
+import sys
+
+OLED_WIDTH = 128
+OLED_HEIGHT = 64
+SEGMENT_HEIGHT = 16
+ONE_K = 100
+
+DIAL_CENTER_X = OLED_WIDTH // 2
+DIAL_RADIUS = (OLED_HEIGHT - SEGMENT_HEIGHT) - 1
+DIAL_CENTER_Y = OLED_HEIGHT - 1
+LABEL_RADIUS = DIAL_RADIUS - 18
+DIAL_LABEL_Y_OFFSET = 6
+DIAL_LABEL_X_OFFSET = 4
+
+# defaults of lib/gauge/gaugeConfig.h
+MAJOR_TICKS = [0, 1000, 2000, 3000, 4000, 5000]
+MAJOR_TICK_LENGTH = 11
+MINOR_TICKS = [500, 1500, 2500, 3500, 4500]
+MINOR_TICK_LENGTH = 5
+
+DIAL_MAX_RPM = 5000
+HALF_CIRCLE_DEGREES = 180
+
+# glcdfont.c columns (bit 0 at the top) of the digits, 5x7 in a 6x8 cell
+FONT_DIGITS = [
+    [0x3E, 0x51, 0x49, 0x45, 0x3E],
+    [0x00, 0x42, 0x7F, 0x40, 0x00],
+    [0x42, 0x61, 0x51, 0x49, 0x46],
+    [0x21, 0x41, 0x45, 0x4B, 0x31],
+    [0x18, 0x14, 0x12, 0x7F, 0x10],
+    [0x27, 0x45, 0x45, 0x45, 0x39],
+    [0x3C, 0x4A, 0x49, 0x49, 0x30],
+    [0x01, 0x71, 0x09, 0x05, 0x03],
+    [0x36, 0x49, 0x49, 0x49, 0x36],
+    [0x06, 0x49, 0x49, 0x29, 0x1E],
+]
+
+
+def f32(value):
+    return struct.unpack('f', struct.pack('f', value))[0]
+
+
+PI_RADIANS = f32(f32(math.pi) / HALF_CIRCLE_DEGREES)
+
+
+class Canvas:
+    def __init__(self):
+        self.pixels = [[0] * OLED_WIDTH for _ in range(OLED_HEIGHT)]
+
+    def pixel(self, x, y):
+        if 0 <= x < OLED_WIDTH and 0 <= y < OLED_HEIGHT:
+            self.pixels[y][x] = 1
+
+    # Adafruit_GFX::drawCircle
+    def circle(self, x0, y0, r):
+        f = 1 - r
+        ddf_x = 1
+        ddf_y = -2 * r
+        x = 0
+        y = r
+        self.pixel(x0, y0 + r)
+        self.pixel(x0, y0 - r)
+        self.pixel(x0 + r, y0)
+        self.pixel(x0 - r, y0)
+        while x < y:
+            if f >= 0:
+                y -= 1
+                ddf_y += 2
+                f += ddf_y
+            x += 1
+            ddf_x += 2
+            f += ddf_x
+            for px, py in ((x, y), (-x, y), (x, -y), (-x, -y),
+                           (y, x), (-y, x), (y, -x), (-y, -x)):
+                self.pixel(x0 + px, y0 + py)
+
+    # Adafruit_GFX::writeLine, fast H/V lines light the same pixels
+    def line(self, x0, y0, x1, y1):
+        steep = abs(y1 - y0) > abs(x1 - x0)
+        if steep:
+            x0, y0 = y0, x0
+            x1, y1 = y1, x1
+        if x0 > x1:
+            x0, x1 = x1, x0
+            y0, y1 = y1, y0
+        dx = x1 - x0
+        dy = abs(y1 - y0)
+        err = dx // 2
+        ystep = 1 if y0 < y1 else -1
+        while x0 <= x1:
+            if steep:
+                self.pixel(y0, x0)
+            else:
+                self.pixel(x0, y0)
+            err -= dy
+            if err < 0:
+                y0 += ystep
+                err += dx
+            x0 += 1
+
+    # Adafruit_GFX::print with text size 1 and a transparent background
+    def text(self, x, y, string):
+        for char in string:
+            columns = FONT_DIGITS[ord(char) - ord('0')]
+            for i, column in enumerate(columns):
+                for j in range(8):
+                    if column & (1 << j):
+                        self.pixel(x + i, y + j)
+            x += 6
+
+
+def tick_angle(rpm, max_rpm):
+    percent = f32(f32(rpm * 1.0) / f32(max_rpm * 1.0))
+    return f32(f32(HALF_CIRCLE_DEGREES * percent) + HALF_CIRCLE_DEGREES)
+
+
+def circle_x(radius, angle):
+    return int(f32(DIAL_CENTER_X + f32(radius * f32(math.cos(f32(angle * PI_RADIANS))))))
+
+
+def circle_y(radius, angle):
+    return int(f32(DIAL_CENTER_Y + f32(radius * f32(math.sin(f32(angle * PI_RADIANS))))))
+
+
+def draw_ticks(canvas, ticks, length, max_rpm):
+    for rpm in ticks:
+        angle = tick_angle(rpm, max_rpm)
+        canvas.line(circle_x(DIAL_RADIUS - 1, angle), circle_y(DIAL_RADIUS - 1, angle),
+                    circle_x(DIAL_RADIUS - length, angle), circle_y(DIAL_RADIUS - length, angle))
+
+
+def draw_labels(canvas, ticks, max_rpm):
+    for index, rpm in enumerate(ticks):
+        if index % 2 == 0:
+            continue
+        angle = tick_angle(rpm, max_rpm)
+        x = circle_x(LABEL_RADIUS, angle)
+        y = circle_y(LABEL_RADIUS, angle)
+        canvas.text(x - DIAL_LABEL_X_OFFSET, y - DIAL_LABEL_Y_OFFSET, str(rpm // ONE_K))
+
+
+def tick_list(text):
+    return [int(value) for value in text.split(',')]
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Render the RPM dial face bitmap')
+    parser.add_argument('--max-rpm', type=int, default=DIAL_MAX_RPM)
+    parser.add_argument('--major-ticks', type=tick_list, default=MAJOR_TICKS)
+    parser.add_argument('--minor-ticks', type=tick_list, default=MINOR_TICKS)
+    args = parser.parse_args()
+
+    canvas = Canvas()
+    canvas.circle(DIAL_CENTER_X, DIAL_CENTER_Y, DIAL_RADIUS)
+    draw_ticks(canvas, args.major_ticks, MAJOR_TICK_LENGTH, args.max_rpm)
+    draw_ticks(canvas, args.minor_ticks, MINOR_TICK_LENGTH, args.max_rpm)
+    draw_labels(canvas, args.major_ticks, args.max_rpm)
+
+    # SSD1306 page layout: 8 rows per byte, LSB on top, pages top to bottom
+    data = []
+    for page in range(OLED_HEIGHT // 8):
+        for x in range(OLED_WIDTH):
+            byte = 0
+            for bit in range(8):
+                byte |= canvas.pixels[page * 8 + bit][x] << bit
+            data.append(byte)
+
+    out = sys.stdout
+    out.write('// Generated by tools/gen_dial_face.py, do not edit.\n')
+    out.write('#ifndef _DIAL_FACE_H\n#define _DIAL_FACE_H\n\n')
+    out.write('#include <Arduino.h>\n\n')
+    out.write('#define DIAL_FACE_WIDTH %d\n' % OLED_WIDTH)
+    out.write('#define DIAL_FACE_HEIGHT %d\n' % OLED_HEIGHT)
+    out.write('#define DIAL_FACE_MAX_RPM %d\n' % args.max_rpm)
+    out.write('#define DIAL_FACE_MAJOR_TICKS %s\n' % ', '.join(str(t) for t in args.major_ticks))
+    out.write('#define DIAL_FACE_MINOR_TICKS %s\n\n' % ', '.join(str(t) for t in args.minor_ticks))
+    out.write('const uint8_t DIAL_FACE[] PROGMEM = {\n')
+    for offset in range(0, len(data), 16):
+        out.write('  ' + ', '.join('0x%02X' % b for b in data[offset:offset + 16]) + ',\n')
+    out.write('};\n\n#endif\n')
+
+
+if __name__ == '__main__':
+    main()